@@ -0,0 +1,544 @@
+###########################################################################
+#                                                                         #
+#                               benchmark.py                              #
+#                               ############                              #
+#                                                                         #
+# Drives the simulator through the exchanges the APF9 CTD driver          #
+# (sbe41.c) has with an SBE41 and times every one of them against the     #
+# timeout the driver gives it:                                            #
+#                                                                         #
+#   Sbe41EnterCmdMode()  wake (request line high 1 sec), \r until S>      #
+#                        (chat, 2 sec), ds until the serial number,       #
+#                        all within 30 sec                                #
+#   Sbe41Config()        pumpfastpt=n, dsreplyformat=s, outputdensity=n,  #
+#                        addtimingdelays=n (chat, 2 sec each)             #
+#   Sbe43Config()        oxnf=2.0, oxns=0.0 (chat, 2 sec each), only      #
+#                        with --oxygen                                    #
+#   Sbe41ExitCmdMode()   \r until S> then qs (30 sec)                     #
+#   Sbe41GetP/Pt/Pts()   a request over the hardware lines until the      #
+#                        sample (5 sec)                                   #
+#   Sbe41GetPtso()       a PTS request with oxygen (60 sec), instead of   #
+#                        the PTS sample with --oxygen. It is only sent    #
+#                        after the pump, as long as Sbe43PumpTime() says  #
+#                        for the p,t of the sample, so it fails if it     #
+#                        comes sooner                                     #
+#                                                                         #
+# The simulator is either the Linux build (host/apf_sim, started here,    #
+# the hardware lines are set through its control file) or a Mega on a     #
+# serial adapter (--port, only the commands, the hardware lines can't be  #
+# driven from here). sbe41.c talks to an SBE41 STD, so the Sbe41Config()  #
+# commands are only answered by the SBE41 STD build                       #
+# (make SKETCH=../APF_9_ARGOS_sim).                                       #
+#                                                                         #
+# Every exchange is run --count times. The results go in --out:           #
+#   samples.csv   one row per exchange: operation, run, seconds, ok       #
+#   summary.json  per operation: timeout, runs, failures, p50, p95, p99   #
+#                 and max (sec), and whether it passed (no failures and   #
+#                 p99 within the timeout), with the build that was run    #
+#                 and, for ptso, the pump time and the energy of a        #
+#                 sample (p50 times --ctd-watts, the power the CTD draws  #
+#                 while it samples, if it is given)                       #
+#   stats.txt     the reply to the simulator's own stats command (and     #
+#                 oxygen command)                                         #
+# The exit status is 1 if any operation failed, for comparing builds.     #
+#                                                                         #
+# python benchmark.py [--sim host/apf_sim | --port /dev/ttyUSB0]          #
+#                     [--count 20] [--out bench] [--pace 1] [--oxygen]    #
+#                     [--ctd-watts 0.5]                                   #
+#                                                                         #
+###########################################################################
+
+from __future__ import print_function
+
+import argparse
+import csv
+import json
+import math
+import os
+import re
+import select
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+#the timeouts (sec) sbe41.c gives each exchange. the P and PT samples are timed by the
+#CTD port driver (CtdPSample, CtdPtSample), not sbe41.c, they are given the PTS timeout
+TIMEOUTS = [
+    ('wake_prompt', 2),
+    ('enter_cmd_mode', 30),
+    ('pumpfastpt=n', 2),
+    ('dsreplyformat=s', 2),
+    ('outputdensity=n', 2),
+    ('addtimingdelays=n', 2),
+    ('oxnf=2.0', 2),
+    ('oxns=0.0', 2),
+    ('exit_cmd_mode', 30),
+    ('p', 5),
+    ('pt', 5),
+    ('pts', 5),
+    ('ptso', 60),
+]
+
+#the serial number in the reply to ds, the same pattern as Sbe41EnterCmdMode()
+SERIALNO = re.compile(br'SERIAL NO\.[^0-9]*([0-9]{4})')
+
+#a PTSO sample, the pedantic pattern of Sbe41GetPtso()
+PTSO = re.compile(br'^[ ]+(-?[0-9]{1,4}\.[0-9]{2}),[ ]+(-?[0-9]{1,2}\.[0-9]{4}),[ ]+(-?[0-9]{1,2}\.[0-9]{4}),'
+                  br'[ ]+([0-9]{1,5})\r\n', re.M)
+
+#the SBE43F settings Sbe43Config() makes and the TAU_20 of the simulator (dc)
+OXYGENN = 2
+OXYGENTAU20 = 2.75
+
+#the hardware lines (pins of the simulator) for each sample, as sbe41.c asks for them:
+#the mode line (3) high for PTS, the Rx line (19) high for PT, both low for P, then a
+#short pulse on the request line (2)
+SAMPLELINES = {
+    'p': 'line 3 0\nline 19 0\nline 2 1\nline 2 0\n',
+    'pt': 'line 3 0\nline 19 1\nline 2 1\nline 2 0\n',
+    'pts': 'line 19 0\nline 3 1\nline 2 1\nline 2 0\n',
+    'ptso': 'line 19 0\nline 3 1\nline 2 1\nline 2 0\n',
+}
+
+
+
+###########################################################################
+#                                                                         #
+#                                 HostLink                                #
+#                                 ########                                #
+#                                                                         #
+# The Linux build of the simulator. It is started with its CTD port       #
+# linked and its control file in a scratch directory, and stopped with    #
+# quit when the benchmark is done.                                        #
+#                                                                         #
+###########################################################################
+
+class HostLink(object):
+    def __init__(self, sim, pace):
+        self.dir = tempfile.mkdtemp(prefix='apfbench')
+        self.control = os.path.join(self.dir, 'control')
+        link = os.path.join(self.dir, 'ctd')
+        os.mkfifo(self.control)
+        self.proc = subprocess.Popen([sim, '-x', str(pace), '-l', link, '-c', self.control],
+                                     stdout=subprocess.PIPE)
+        self.proc.stdout.readline()
+        self.fd = os.open(link, os.O_RDWR | os.O_NOCTTY)
+        self.name = 'host ' + sim
+
+    def canDriveLines(self):
+        return True
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def read(self, timeout):
+        ready = select.select([self.fd], [], [], timeout)[0]
+        if ready:
+            return os.read(self.fd, 4096)
+        return b''
+
+    def lines(self, text):
+        with open(self.control, 'w') as f:
+            f.write(text)
+
+    def close(self):
+        self.lines('quit\n')
+        try:
+            self.proc.wait(timeout=5)
+        except Exception:
+            self.proc.kill()
+        os.close(self.fd)
+        shutil.rmtree(self.dir, ignore_errors=True)
+
+
+
+###########################################################################
+#                                                                         #
+#                                SerialLink                               #
+#                                ##########                               #
+#                                                                         #
+# A Mega running the simulator on a serial adapter (pyserial). Only the   #
+# commands can be sent, the hardware line exchanges are skipped.          #
+#                                                                         #
+###########################################################################
+
+class SerialLink(object):
+    def __init__(self, port, baud):
+        import serial
+        self.port = serial.Serial(port=port, baudrate=baud, timeout=0)
+        self.name = 'serial ' + port
+
+    def canDriveLines(self):
+        return False
+
+    def write(self, data):
+        self.port.write(data)
+
+    def read(self, timeout):
+        end = time.time() + timeout
+        while True:
+            data = self.port.read(self.port.in_waiting or 1)
+            if data or time.time() >= end:
+                return data
+            time.sleep(0.001)
+
+    def lines(self, text):
+        pass
+
+    def close(self):
+        self.port.close()
+
+
+
+###########################################################################
+#                                                                         #
+#                                readUntil                                #
+#                                #########                                #
+#                                                                         #
+# parameters: link, the simulator                                         #
+#             done, a function of everything received so far that is      #
+#                 true once the reply is complete                         #
+#             timeout, the seconds to wait for it                         #
+#                                                                         #
+# returns: everything received, and the seconds it took (None if the      #
+#          reply wasn't complete within the timeout)                      #
+#                                                                         #
+###########################################################################
+
+def readUntil(link, done, timeout, start=None):
+    if start is None:
+        start = time.time()
+    received = b''
+    while True:
+        elapsed = time.time() - start
+        if done(received):
+            return received, elapsed
+        if elapsed >= timeout:
+            return received, None
+        received += link.read(min(0.05, timeout - elapsed))
+
+
+
+###########################################################################
+#                                                                         #
+#                                   chat                                  #
+#                                   ####                                  #
+#                                                                         #
+# parameters: link, the simulator                                         #
+#             command, the bytes to send                                  #
+#             expect, the bytes that end the reply                        #
+#             timeout, the seconds to wait for them                       #
+#                                                                         #
+# returns: the seconds from sending the command to the end of the reply   #
+#          (None on a timeout), like chat() in sbe41.c                    #
+#                                                                         #
+###########################################################################
+
+def chat(link, command, expect, timeout):
+    start = time.time()
+    link.write(command)
+    return readUntil(link, lambda r: expect in r, timeout, start)[1]
+
+
+
+###########################################################################
+#                                                                         #
+#                                 drain                                   #
+#                                 #####                                   #
+#                                                                         #
+# parameters: link, the simulator                                         #
+#                                                                         #
+# returns: none                                                           #
+#                                                                         #
+# Throws away what the simulator sends until it goes quiet, so one        #
+# exchange doesn't see the end of the one before (ctdio.iflush()).        #
+#                                                                         #
+###########################################################################
+
+def drain(link):
+    while link.read(0.1):
+        pass
+
+
+
+###########################################################################
+#                                                                         #
+#                               enterCmdMode                              #
+#                               ############                              #
+#                                                                         #
+# parameters: link, the simulator                                         #
+#             times, the dictionary the timings are added to              #
+#                                                                         #
+# returns: none                                                           #
+#                                                                         #
+# Sbe41EnterCmdMode(): wake the SBE41 (the request line high for a        #
+# second), get the prompt, then send ds and read until the serial number. #
+#                                                                         #
+###########################################################################
+
+def enterCmdMode(link, times):
+    start = time.time()
+    if link.canDriveLines():
+        link.lines('line 3 0\nline 2 1\n')
+        time.sleep(1)
+        link.lines('line 2 0\n')
+    prompt = None
+    while prompt is None and time.time() - start < 30:
+        prompt = chat(link, b'\r', b'S>', 2)
+    times['wake_prompt'].append(prompt)
+    drain(link)
+    link.write(b'ds\r')
+    serial = readUntil(link, lambda r: SERIALNO.search(r), 30 - (time.time() - start))[1]
+    times['enter_cmd_mode'].append(None if (prompt is None or serial is None) else time.time() - start)
+    chat(link, b'\r', b'S>', 2)
+    drain(link)
+
+
+
+###########################################################################
+#                                                                         #
+#                                  config                                 #
+#                                  ######                                 #
+#                                                                         #
+# parameters: link, the simulator                                         #
+#             times, the dictionary the timings are added to              #
+#                                                                         #
+# returns: none                                                           #
+#                                                                         #
+# Sbe41Config(): the four settings, each a chat() of its own, then the    #
+# two of Sbe43Config() if the SBE43F is being sampled.                    #
+#                                                                         #
+###########################################################################
+
+def config(link, times, oxygen):
+    commands = ('pumpfastpt=n', 'dsreplyformat=s', 'outputdensity=n', 'addtimingdelays=n')
+    if oxygen:
+        commands += ('oxnf=2.0', 'oxns=0.0')
+    for command in commands:
+        times[command].append(chat(link, command.encode() + b'\r', b'S>', 2))
+        drain(link)
+
+
+
+###########################################################################
+#                                                                         #
+#                                exitCmdMode                              #
+#                                ###########                              #
+#                                                                         #
+# parameters: link, the simulator                                         #
+#             times, the dictionary the timings are added to              #
+#                                                                         #
+# returns: none                                                           #
+#                                                                         #
+# Sbe41ExitCmdMode(): get the prompt, then power down with qs. The        #
+# simulator answers qs with its prompt once the hardware lines are back   #
+# on.                                                                     #
+#                                                                         #
+###########################################################################
+
+def exitCmdMode(link, times):
+    start = time.time()
+    ok = chat(link, b'\r', b'S>', 2) is not None
+    drain(link)
+    ok = ok and chat(link, b'qs\r', b'S>', 30 - (time.time() - start)) is not None
+    times['exit_cmd_mode'].append(time.time() - start if ok else None)
+    drain(link)
+
+
+
+###########################################################################
+#                                                                         #
+#                                  sample                                 #
+#                                  ######                                 #
+#                                                                         #
+# parameters: link, the simulator                                         #
+#             name, the sample (p, pt, pts or ptso)                       #
+#             timeout, the seconds to wait for it                         #
+#                                                                         #
+# returns: the seconds from the rise of the request line to the end of    #
+#          the sample (None on a timeout) and the sample                  #
+#                                                                         #
+###########################################################################
+
+def sample(link, name, timeout):
+    start = time.time()
+    link.lines(SAMPLELINES[name])
+    reply, elapsed = readUntil(link, lambda r: re.search(br'[0-9]\r\n', r), timeout, start)
+    link.lines('line 3 0\nline 19 0\n')
+    drain(link)
+    return elapsed, reply
+
+
+
+###########################################################################
+#                                                                         #
+#                                 pumpTime                                #
+#                                 ########                                #
+#                                                                         #
+# parameters: reply, a PTSO sample                                        #
+#                                                                         #
+# returns: the seconds the SBE43F pumps before the sample, the same as    #
+#          Sbe43PumpTime() in sbe41.c for its p,t (None if the sample     #
+#          isn't a PTSO sample)                                           #
+#                                                                         #
+###########################################################################
+
+def pumpTime(reply):
+    match = PTSO.search(reply)
+    if match is None:
+        return None
+    p, t = float(match.group(1)), float(match.group(2))
+    if t < -2 or t > 40:
+        t = 4
+    if p < 0 or p > 2500:
+        p = 2000
+    tau = min(max(OXYGENTAU20*math.exp(1.964e-4*p)*math.exp(-4.1776e-2*(t - 20)), 2.0), 30.0)
+    return min(max(int(OXYGENN*tau + 0.5), 7), 100)
+
+
+
+###########################################################################
+#                                                                         #
+#                                percentile                               #
+#                                ##########                               #
+#                                                                         #
+# parameters: values, the sorted timings                                  #
+#             p, the percentile (0-100)                                   #
+#                                                                         #
+# returns: the nearest-rank percentile of the timings                     #
+#                                                                         #
+###########################################################################
+
+def percentile(values, p):
+    if not values:
+        return None
+    return values[max(0, int(math.ceil(p/100.0*len(values))) - 1)]
+
+
+
+###########################################################################
+#                                                                         #
+#                                 summarize                               #
+#                                 #########                               #
+#                                                                         #
+# parameters: times, the timings of each operation                        #
+#             pumps, the pump time of each PTSO sample                    #
+#             args, the options the benchmark was run with                #
+#             link, the simulator                                         #
+#                                                                         #
+# returns: the summary that goes in summary.json                          #
+#                                                                         #
+###########################################################################
+
+def summarize(times, pumps, args, link):
+    try:
+        build = subprocess.check_output(['git', 'describe', '--always', '--dirty'], stderr=subprocess.STDOUT,
+                                        cwd=os.path.dirname(os.path.abspath(__file__))).decode().strip()
+    except Exception:
+        build = 'unknown'
+    summary = {'build': build, 'simulator': link.name, 'pace': args.pace,
+               'runs': args.count, 'time': time.strftime('%Y-%m-%dT%H:%M:%S'), 'operations': {}}
+    for name, timeout in TIMEOUTS:
+        if not times[name]:
+            continue
+        done = sorted(t for t in times[name] if t is not None)
+        failures = len(times[name]) - len(done)
+        p99 = percentile(done, 99)
+        summary['operations'][name] = {
+            'timeout_s': timeout,
+            'runs': len(times[name]),
+            'failures': failures,
+            'p50_s': percentile(done, 50),
+            'p95_s': percentile(done, 95),
+            'p99_s': p99,
+            'max_s': done[-1] if done else None,
+            'pass': failures == 0 and p99 is not None and p99 <= timeout,
+        }
+    if 'ptso' in summary['operations']:
+        ptso = summary['operations']['ptso']
+        done = [t for t in pumps if t is not None]
+        ptso['pump_mean_s'] = sum(done)/float(len(done)) if done else None
+        ptso['pump_max_s'] = max(done) if done else None
+        ptso['energy_p50_j'] = ptso['p50_s']*args.ctd_watts if args.ctd_watts and ptso['p50_s'] else None
+    return summary
+
+
+
+###########################################################################
+#                                                                         #
+#                                   main                                  #
+#                                   ####                                  #
+#                                                                         #
+# Runs every exchange --count times, then writes the results and prints   #
+# a table of them.                                                        #
+#                                                                         #
+###########################################################################
+
+def main():
+    parser = argparse.ArgumentParser(description='time the simulator against the sbe41.c timeouts')
+    parser.add_argument('--sim', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), 'host', 'apf_sim'))
+    parser.add_argument('--port')
+    parser.add_argument('--baud', type=int, default=9600)
+    parser.add_argument('--pace', type=float, default=1)
+    parser.add_argument('--count', type=int, default=20)
+    parser.add_argument('--out', default='bench')
+    parser.add_argument('--oxygen', action='store_true')
+    parser.add_argument('--ctd-watts', type=float)
+    args = parser.parse_args()
+
+    link = SerialLink(args.port, args.baud) if args.port else HostLink(args.sim, args.pace)
+    times = dict((name, []) for name, timeout in TIMEOUTS)
+    pumps = []
+    try:
+        drain(link)
+        for run in range(args.count):
+            enterCmdMode(link, times)
+            config(link, times, args.oxygen)
+            exitCmdMode(link, times)
+            if link.canDriveLines():
+                for name in ('p', 'pt') + (('ptso',) if args.oxygen else ('pts',)):
+                    elapsed, reply = sample(link, name, dict(TIMEOUTS)[name])
+                    #a PTSO sample has to wait for the pump, one that comes sooner is a failure
+                    if name == 'ptso':
+                        pumps.append(pumpTime(reply))
+                        if elapsed is not None and (pumps[-1] is None or elapsed < pumps[-1]/args.pace):
+                            elapsed = None
+                    times[name].append(elapsed)
+        link.write(b'stats\r')
+        stats = readUntil(link, lambda r: r.endswith(b'\r\nS>\x00'), 5)[0]
+        if args.oxygen:
+            link.write(b'oxygen\r')
+            stats += readUntil(link, lambda r: r.endswith(b'\r\nS>\x00'), 5)[0]
+    finally:
+        link.close()
+
+    if not os.path.isdir(args.out):
+        os.makedirs(args.out)
+    with open(os.path.join(args.out, 'samples.csv'), 'w') as f:
+        writer = csv.writer(f)
+        writer.writerow(['operation', 'run', 'seconds', 'ok'])
+        for name, timeout in TIMEOUTS:
+            for run, t in enumerate(times[name]):
+                writer.writerow([name, run, '' if t is None else '%.6f' % t, int(t is not None and t <= timeout)])
+    summary = summarize(times, pumps, args, link)
+    with open(os.path.join(args.out, 'summary.json'), 'w') as f:
+        json.dump(summary, f, indent=2, sort_keys=True)
+    with open(os.path.join(args.out, 'stats.txt'), 'wb') as f:
+        f.write(stats.replace(b'\x00', b''))
+
+    print('%-18s %8s %8s %8s %8s %8s %5s' % ('operation', 'timeout', 'p50', 'p95', 'p99', 'max', 'fail'))
+    for name, timeout in TIMEOUTS:
+        result = summary['operations'].get(name)
+        if result is None:
+            continue
+        cells = ['-' if result[k] is None else '%.3f' % result[k] for k in ('p50_s', 'p95_s', 'p99_s', 'max_s')]
+        print('%-18s %8d %8s %8s %8s %8s %5d%s' % tuple([name, timeout] + cells + [result['failures'],
+              '' if result['pass'] else '  FAILED']))
+    return 0 if all(r['pass'] for r in summary['operations'].values()) else 1
+
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,104 @@
+/*************************************************************************/
+/*                               Arduino.h                               */
+/*                               *********                               */
+/*                                                                       */
+/* The part of the arduino core the simulator uses besides its hardware  */
+/* (hal.h), for building the sketch as a Linux program: the types, the   */
+/* PROGMEM macros, String and Serial (the debug port, written to stderr  */
+/* when the simulator is run with -v).                                   */
+/*                                                                       */
+/*************************************************************************/
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+
+//PROGMEM is ordinary memory on Linux, reading it reads the value itself (with its own type,
+//a long is wider than the dword it is on the Mega)
+#define PROGMEM
+#define pgm_read_byte(address) (*(address))
+#define pgm_read_word(address) (*(address))
+#define pgm_read_dword(address) (*(address))
+#define pgm_read_ptr(address) (*(address))
+#define strcpy_P strcpy
+
+/*************************************************************************/
+/*                                 String                                */
+/*                                 ******                                */
+/*                                                                       */
+/* The arduino String, as much of it as the simulator uses.              */
+/*                                                                       */
+/*************************************************************************/
+
+class String {
+  public:
+    String(const char *text = "") : value(text ? text : "") {}
+    String(const std::string &text) : value(text) {}
+    String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+    String(double number, int decimals = 2){
+      char text[40];
+      snprintf(text, sizeof(text), "%.*f", decimals, number);
+      value = text;
+    }
+
+    unsigned int length(void) const { return value.size(); }
+    const char *c_str(void) const { return value.c_str(); }
+    boolean equals(const String &other) const { return value == other.value; }
+    boolean operator==(const String &other) const { return value == other.value; }
+    boolean operator!=(const String &other) const { return value != other.value; }
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : 0; }
+    long toInt(void) const { return atol(value.c_str()); }
+
+    String &operator+=(const String &other){ value += other.value; return *this; }
+    friend String operator+(const String &a, const String &b){ return String(a.value + b.value); }
+    friend String operator+(const String &a, const char *b){ return String(a.value + b); }
+    friend String operator+(const char *a, const String &b){ return String(a + b.value); }
+
+  private:
+    std::string value;
+};
+
+/*************************************************************************/
+/*                                 Serial                                */
+/*                                 ******                                */
+/*                                                                       */
+/* The debug port, what is printed goes to stderr if serialDebug is set. */
+/*                                                                       */
+/*************************************************************************/
+
+extern boolean serialDebug;
+
+class DebugSerial {
+  public:
+    void begin(long){}
+    void print(const String &text){
+      if(serialDebug){
+        fputs(text.c_str(), stderr);
+      }
+    }
+    void println(const String &text){
+      print(text);
+      print("\n");
+    }
+};
+
+extern DebugSerial Serial;
+
+#endif
@@ -0,0 +1,70 @@
+/*************************************************************************/
+/*                                EEPROM.h                               */
+/*                                ********                               */
+/*                                                                       */
+/* The EEPROM of the Mega for building the sketch as a Linux program. It */
+/* starts blank (0xFF) or with the contents of the file given with -e,   */
+/* and every put is written back to that file.                           */
+/*                                                                       */
+/*************************************************************************/
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <stdio.h>
+#include <string.h>
+
+#define EEPROMSIZE 4096
+
+class EEPROMClass {
+  public:
+    EEPROMClass(void) : file(NULL) {
+      memset(memory, 0xFF, sizeof(memory));
+    }
+
+    //keep the EEPROM in file, starting with what it already holds
+    void open(const char *name){
+      FILE *in = fopen(name, "rb");
+      file = name;
+      if(in != NULL){
+        if(fread(memory, 1, sizeof(memory), in) == 0){
+          memset(memory, 0xFF, sizeof(memory));
+        }
+        fclose(in);
+      }
+    }
+
+    template <class T> T &get(int address, T &value){
+      memcpy(&value, memory + address, sizeof(T));
+      return value;
+    }
+
+    template <class T> const T &put(int address, const T &value){
+      memcpy(memory + address, &value, sizeof(T));
+      save();
+      return value;
+    }
+
+  private:
+    void save(void){
+      FILE *out;
+      if(file == NULL){
+        return;
+      }
+      out = fopen(file, "wb");
+      if(out != NULL){
+        fwrite(memory, 1, sizeof(memory), out);
+        fclose(out);
+      }
+    }
+
+    unsigned char memory[EEPROMSIZE];
+    const char *file;
+};
+
+//each float of the farm has its own EEPROM, EEPROM is the one of the float that is running
+extern EEPROMClass *eeprom;
+
+#define EEPROM (*eeprom)
+
+#endif
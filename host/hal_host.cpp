@@ -0,0 +1,790 @@
+/*************************************************************************/
+/*                              hal_host.cpp                             */
+/*                              ************                             */
+/*                                                                       */
+/* The hardware of hal.h for running the simulator as a Linux program,   */
+/* one float or a farm of them (-n) in one process.                      */
+/*                                                                       */
+/* The CTD port (Serial1) of each float is a pseudo-terminal, its name   */
+/* is printed when the simulator starts (and linked to with -l, the link */
+/* gets the float number added with more than one float), the APFx or a  */
+/* test script talks to it the same as the Mega's Serial1. Bytes are     */
+/* sent no faster than the baud rate would let them out.                 */
+/*                                                                       */
+/* The recorded profile (-r, made by replay.py) is memory mapped once    */
+/* and shared by the floats, its samples are read in place.              */
+/*                                                                       */
+/* The SD card the simulator records to is a directory (-d, made if it   */
+/* doesn't exist, the float number is added with more than one float).   */
+/*                                                                       */
+/* The hardware lines and the pistons come from a control file (-c, a    */
+/* FIFO is made if it doesn't exist), one setting per line:              */
+/*   float <n>           the next settings are for float n (0 at first)  */
+/*   line <pin> <0|1>    set hardware line 2, 3 or 19, a rising edge on  */
+/*                       2 is a request (checkLine)                      */
+/*   piston <0-1023>     set the piston position (A0)                    */
+/*   stats               print how the floats are keeping up             */
+/*   quit                stop the simulator                              */
+/*                                                                       */
+/* Each float has its own virtual clock, it moves on by a step (-s, us)  */
+/* each time through the loop and by the time of every delay. Timer1     */
+/* (the line decoder) runs off it. -x paces the clocks against real      */
+/* time: 1 (the default) is real time, 0 runs as fast as the CPU allows, */
+/* for test suites that drive the lines from the control file.           */
+/*                                                                       */
+/* The farm: the sketch keeps its state in globals, so the Makefile puts */
+/* them all in the sections sketch_data and sketch_bss. Only one float   */
+/* is running at a time, the state of the others is kept in their Float  */
+/* and copied in when it is their turn, so a float costs the size of the */
+/* sketch's globals plus its Float (printed at start). One event loop    */
+/* runs a pass of the loop for each float that is due and waits on the   */
+/* pseudo-terminals and the control file (epoll) when none is.           */
+/*                                                                       */
+/*************************************************************************/
+
+#include "hal.h"
+#include <EEPROM.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+void setup(void);
+
+void loop(void);
+
+//the size of the Mega's Serial1 buffers
+#define CTDBUFFERSIZE 64
+
+#define CONTROLSIZE 128
+
+#define NAMESIZE 256
+
+//the sketch's globals, see the Makefile
+extern byte __start_sketch_data[], __stop_sketch_data[];
+extern byte __start_sketch_bss[], __stop_sketch_bss[];
+
+/*************************************************************************/
+/*                                 Float                                 */
+/*                                 *****                                 */
+/*                                                                       */
+/* Everything one float of the farm has: the sketch's globals (while     */
+/* another float is running), its clock, CTD port, hardware lines,       */
+/* piston, Timer1, request interrupt, EEPROM and SD card.                */
+/*                                                                       */
+/*************************************************************************/
+
+struct Float {
+  byte *state;
+
+  unsigned long long clockNow;
+  unsigned long passes;
+
+  int ctdMaster, ctdSlave;
+  long ctdBaud;
+  double ctdRoom;
+  unsigned long long ctdLast;
+  byte ctdIn[CTDBUFFERSIZE];
+  int ctdInHead, ctdInTail;
+
+  int lines[20];
+  int piston;
+  void (*requestIsr)(void);
+
+  long timerPeriod;
+  void (*timerIsr)(void);
+  boolean timerRunning;
+  unsigned long long timerNext;
+
+  EEPROMClass eeprom;
+
+  char storageDir[NAMESIZE];
+  int storageFd[STORAGEFILES];
+
+  char link[NAMESIZE];
+};
+
+boolean serialDebug = false;
+
+DebugSerial Serial;
+
+EEPROMClass *eeprom = NULL;
+
+static Float *floats = NULL;
+static int nFloats = 1;
+static Float *current = NULL;
+static Float *controlled = NULL;
+static size_t dataSize, bssSize;
+
+static unsigned long clockStep = 100;
+static double clockPace = 1;
+static struct timespec wallStart;
+
+static int controlFd = -1, controlWriter = -1;
+static char control[CONTROLSIZE];
+static int controlLen = 0;
+
+static volatile sig_atomic_t running = 1;
+
+static const byte *replayMap = NULL;
+static size_t replayBytes = 0;
+
+/*************************************************************************/
+/*                                runFloat                               */
+/*                                ********                               */
+/*                                                                       */
+/* parameters: f, the float to run                                       */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function makes f the float that is running: the sketch's globals */
+/* of the float that was running are kept in its Float and the ones of f */
+/* are copied in. Nothing is copied with only one float.                 */
+/*                                                                       */
+/*************************************************************************/
+
+static void runFloat(Float *f){
+  if(f == current){
+    return;
+  }
+  if(current != NULL){
+    memcpy(current->state, __start_sketch_data, dataSize);
+    memcpy(current->state + dataSize, __start_sketch_bss, bssSize);
+  }
+  memcpy(__start_sketch_data, f->state, dataSize);
+  memcpy(__start_sketch_bss, f->state + dataSize, bssSize);
+  current = f;
+  eeprom = &f->eeprom;
+}
+
+/*************************************************************************/
+/*                              wallMicros                               */
+/*                              **********                               */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: the real time (us) since the simulator started               */
+/*                                                                       */
+/*************************************************************************/
+
+static double wallMicros(void){
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - wallStart.tv_sec)*1e6 + (now.tv_nsec - wallStart.tv_nsec)/1e3;
+}
+
+/*************************************************************************/
+/*                              advanceClock                             */
+/*                              ************                             */
+/*                                                                       */
+/* parameters: us, an unsigned long that represents how far (us) to move */
+/*                  the virtual clock on                                 */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function moves the clock of the running float on, runs Timer1    */
+/* each time its period is up, and, paced with only one float, waits for */
+/* real time to catch up. With more than one float, a float that is      */
+/* ahead waits for its turn in the event loop instead.                   */
+/*                                                                       */
+/*************************************************************************/
+
+static void advanceClock(unsigned long us){
+  struct timespec wait;
+  double ahead;
+
+  current->clockNow += us;
+  while(current->timerRunning&&(current->timerIsr != NULL)&&(current->clockNow >= current->timerNext)){
+    current->timerNext += current->timerPeriod;
+    current->timerIsr();
+  }
+
+  if((clockPace > 0)&&(nFloats == 1)){
+    ahead = current->clockNow/clockPace - wallMicros();
+
+    //only sleep once ahead by a ms, not every step
+    if(ahead > 1000){
+      wait.tv_sec = (long)(ahead/1e6);
+      wait.tv_nsec = (long)(ahead - wait.tv_sec*1e6)*1000;
+      nanosleep(&wait, NULL);
+    }
+  }
+}
+
+/*************************************************************************/
+/*                                 hal.h                                 */
+/*                                 *****                                 */
+/*                                                                       */
+/* For the float that is running.                                        */
+/*                                                                       */
+/*************************************************************************/
+
+void halSetup(void){
+}
+
+void ctdBegin(long baud){
+  current->ctdBaud = baud;
+  current->ctdRoom = CTDBUFFERSIZE;
+  current->ctdLast = current->clockNow;
+  if(serialDebug){
+    fprintf(stderr, "CTD port %d at %ld baud\n", int(current - floats), baud);
+  }
+}
+
+int ctdAvailable(void){
+  byte data[CTDBUFFERSIZE];
+  int room = (current->ctdInTail - current->ctdInHead - 1 + CTDBUFFERSIZE)%CTDBUFFERSIZE;
+  int i, n;
+
+  if(room > 0){
+    n = read(current->ctdMaster, data, room);
+    for(i = 0; i < n; i++){
+      current->ctdIn[current->ctdInHead] = data[i];
+      current->ctdInHead = (current->ctdInHead + 1)%CTDBUFFERSIZE;
+    }
+  }
+  return (current->ctdInHead - current->ctdInTail + CTDBUFFERSIZE)%CTDBUFFERSIZE;
+}
+
+int ctdRead(void){
+  int data;
+  if((current->ctdInHead == current->ctdInTail)&&(ctdAvailable() == 0)){
+    return -1;
+  }
+  data = current->ctdIn[current->ctdInTail];
+  current->ctdInTail = (current->ctdInTail + 1)%CTDBUFFERSIZE;
+  return data;
+}
+
+//the transmit buffer empties at the baud rate (10 bits a byte). when it is full, the time
+//until the next byte is out passes, the clock only moves on between calls otherwise and
+//writeBytes would wait for room forever
+int ctdAvailableForWrite(void){
+  double rate = current->ctdBaud/10/1e6;
+  current->ctdRoom += (current->clockNow - current->ctdLast)*rate;
+  current->ctdLast = current->clockNow;
+  if(current->ctdRoom < 1){
+    advanceClock((unsigned long)((1 - current->ctdRoom)/rate) + 1);
+    current->ctdRoom += (current->clockNow - current->ctdLast)*rate;
+    current->ctdLast = current->clockNow;
+  }
+  if(current->ctdRoom > CTDBUFFERSIZE - 1){
+    current->ctdRoom = CTDBUFFERSIZE - 1;
+  }
+  return (int)current->ctdRoom;
+}
+
+//a byte nobody is reading (the pseudo-terminal is full) is lost, the same as on an
+//unplugged Serial1
+void ctdWrite(byte data){
+  if(write(current->ctdMaster, &data, 1) < 0){
+    errno = 0;
+  }
+  current->ctdRoom -= 1;
+}
+
+void ctdFlush(void){
+}
+
+int readLine(int pin){
+  return current->lines[pin];
+}
+
+int readPiston(void){
+  return current->piston;
+}
+
+void writeLed(int value){
+}
+
+unsigned long clockMillis(void){
+  return (unsigned long)(current->clockNow/1000);
+}
+
+unsigned long clockMicros(void){
+  return (unsigned long)current->clockNow;
+}
+
+void clockDelay(unsigned long ms){
+  unsigned long long end = current->clockNow + ms*1000ULL;
+  while(current->clockNow < end){
+    advanceClock((end - current->clockNow < clockStep) ? (unsigned long)(end - current->clockNow) : clockStep);
+  }
+}
+
+void lineTimerInit(long period, void (*isr)(void)){
+  current->timerPeriod = period;
+  current->timerIsr = isr;
+  current->timerRunning = false;
+}
+
+void lineTimerStart(void){
+  current->timerNext = current->clockNow + current->timerPeriod;
+  current->timerRunning = true;
+}
+
+void lineTimerStop(void){
+  current->timerRunning = false;
+}
+
+void requestAttach(void (*isr)(void)){
+  current->requestIsr = isr;
+}
+
+void requestDetach(void){
+  current->requestIsr = NULL;
+}
+
+long replayOpen(void){
+  return (long)replayBytes;
+}
+
+const byte *replayRead(unsigned long offset, byte *buffer, int len){
+  if((replayMap == NULL)||(offset + len > replayBytes)){
+    return NULL;
+  }
+  return replayMap + offset;
+}
+
+long storageOpen(byte file, const char *name){
+  char path[2*NAMESIZE];
+  struct stat status;
+  int fd;
+
+  if(current->storageDir[0] == '\0'){
+    return -1;
+  }
+  if(current->storageFd[file] >= 0){
+    close(current->storageFd[file]);
+    current->storageFd[file] = -1;
+  }
+  snprintf(path, sizeof(path), "%s/%s", current->storageDir, name);
+  fd = open(path, O_RDWR | O_CREAT, 0644);
+  if((fd < 0)||(fstat(fd, &status) != 0)){
+    if(fd >= 0){
+      close(fd);
+    }
+    return -1;
+  }
+  current->storageFd[file] = fd;
+  return status.st_size/STORAGEBLOCK;
+}
+
+boolean storageWrite(byte file, unsigned long block, const byte *data){
+  if(current->storageFd[file] < 0){
+    return false;
+  }
+  return pwrite(current->storageFd[file], data, STORAGEBLOCK, (off_t)block*STORAGEBLOCK) == STORAGEBLOCK;
+}
+
+void storageSync(byte file){
+  if(current->storageFd[file] >= 0){
+    fdatasync(current->storageFd[file]);
+  }
+}
+
+/*************************************************************************/
+/*                               printStats                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function prints how many floats there are, the memory each one   */
+/* costs, how many times a second (real time) each has been through the  */
+/* loop, and how far (ms) the slowest clock is behind the pace, which    */
+/* keeps growing once there are more floats than the box can keep up     */
+/* with.                                                                 */
+/*                                                                       */
+/*************************************************************************/
+
+static void printStats(void){
+  double seconds = wallMicros()/1e6;
+  double behind, worst = 0;
+  unsigned long passes = 0;
+  int i;
+
+  for(i = 0; i < nFloats; i++){
+    passes += floats[i].passes;
+    behind = (seconds*1e6*clockPace - floats[i].clockNow)/1000;
+    if((clockPace > 0)&&(behind > worst)){
+      worst = behind;
+    }
+  }
+  printf("floats %d, %lu bytes of sketch state + %lu bytes each, %.0f passes/s each, %.1f ms behind\n",
+    nFloats, (unsigned long)(dataSize + bssSize), (unsigned long)sizeof(Float),
+    (seconds > 0) ? passes/seconds/nFloats : 0.0, worst);
+  fflush(stdout);
+}
+
+/*************************************************************************/
+/*                               doControl                               */
+/*                               *********                               */
+/*                                                                       */
+/* parameters: text, a line of the control file                          */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function picks the float the next lines are for, sets one of its */
+/* hardware lines or its piston, prints the stats or stops the simulator.*/
+/*                                                                       */
+/*************************************************************************/
+
+static void doControl(const char *text){
+  int pin, value;
+
+  if(sscanf(text, "float %d", &value) == 1){
+    if((value < 0)||(value >= nFloats)){
+      fprintf(stderr, "no float %d\n", value);
+      return;
+    }
+    controlled = &floats[value];
+  }
+  else if(sscanf(text, "line %d %d", &pin, &value) == 2){
+    if((pin != 2)&&(pin != 3)&&(pin != 19)){
+      fprintf(stderr, "no hardware line on pin %d\n", pin);
+      return;
+    }
+    if((pin == 2)&&(controlled->lines[2] == LOW)&&(value != LOW)&&(controlled->requestIsr != NULL)){
+      runFloat(controlled);
+      current->lines[2] = HIGH;
+      current->requestIsr();
+    }
+    controlled->lines[pin] = (value != LOW) ? HIGH : LOW;
+  }
+  else if(sscanf(text, "piston %d", &value) == 1){
+    controlled->piston = (value < 0) ? 0 : (value > 1023) ? 1023 : value;
+  }
+  else if(strncmp(text, "stats", 5) == 0){
+    printStats();
+  }
+  else if(strncmp(text, "quit", 4) == 0){
+    running = 0;
+  }
+  else if((text[0] != '\0')&&(text[0] != '#')){
+    fprintf(stderr, "unknown control: %s\n", text);
+  }
+}
+
+/*************************************************************************/
+/*                              readControl                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Called every time through the event loop. This function does each    */
+/* whole line that has been written to the control file since it was    */
+/* last called.                                                          */
+/*                                                                       */
+/*************************************************************************/
+
+static void readControl(void){
+  char c;
+  while(read(controlFd, &c, 1) == 1){
+    if(c == '\r'){
+      continue;
+    }
+    if(c == '\n'){
+      control[controlLen] = '\0';
+      doControl(control);
+      controlLen = 0;
+    }
+    else if(controlLen < CONTROLSIZE - 1){
+      control[controlLen++] = c;
+    }
+  }
+}
+
+/*************************************************************************/
+/*                              openControl                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: name, the path of the control file                        */
+/*                                                                       */
+/* returns: a boolean that is true if the control file could be opened   */
+/*                                                                       */
+/* This function opens the control file, making a FIFO if there isn't    */
+/* one. A FIFO is also kept open for writing so it doesn't end when a    */
+/* writer closes it.                                                     */
+/*                                                                       */
+/*************************************************************************/
+
+static boolean openControl(const char *name){
+  struct stat info;
+  if((stat(name, &info) != 0)&&(mkfifo(name, 0666) != 0)){
+    perror(name);
+    return false;
+  }
+  controlFd = open(name, O_RDONLY|O_NONBLOCK);
+  if(controlFd < 0){
+    perror(name);
+    return false;
+  }
+  if((fstat(controlFd, &info) == 0)&&S_ISFIFO(info.st_mode)){
+    controlWriter = open(name, O_WRONLY|O_NONBLOCK);
+  }
+  return true;
+}
+
+/*************************************************************************/
+/*                                openCtd                                */
+/*                                *******                                */
+/*                                                                       */
+/* parameters: f, the float to open the CTD port of                      */
+/*                                                                       */
+/* returns: a boolean that is true if the CTD port could be opened       */
+/*                                                                       */
+/* This function opens the pseudo-terminal of the CTD port, raw (8-N-1,  */
+/* no echo), and links to it. The other end is kept open so the port     */
+/* stays up while the APFx or script isn't connected.                    */
+/*                                                                       */
+/*************************************************************************/
+
+static boolean openCtd(Float *f){
+  struct termios settings;
+  const char *name;
+
+  f->ctdMaster = posix_openpt(O_RDWR|O_NOCTTY);
+  if((f->ctdMaster < 0)||(grantpt(f->ctdMaster) != 0)||(unlockpt(f->ctdMaster) != 0)){
+    perror("CTD port");
+    return false;
+  }
+  name = ptsname(f->ctdMaster);
+  f->ctdSlave = open(name, O_RDWR|O_NOCTTY);
+  if(f->ctdSlave < 0){
+    perror(name);
+    return false;
+  }
+  tcgetattr(f->ctdSlave, &settings);
+  cfmakeraw(&settings);
+  tcsetattr(f->ctdSlave, TCSANOW, &settings);
+  fcntl(f->ctdMaster, F_SETFL, fcntl(f->ctdMaster, F_GETFL) | O_NONBLOCK);
+
+  if(f->link[0] != '\0'){
+    unlink(f->link);
+    if(symlink(name, f->link) != 0){
+      perror(f->link);
+      return false;
+    }
+  }
+  printf("CTD port %d: %s\n", int(f - floats), name);
+  return true;
+}
+
+/*************************************************************************/
+/*                               openReplay                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: name, the recorded profile given with -r                  */
+/*                                                                       */
+/* returns: a boolean that is true if the profile could be mapped        */
+/*                                                                       */
+/* This function maps the recorded profile into memory read only, it is  */
+/* never copied, replayRead hands out pointers into it.                  */
+/*                                                                       */
+/*************************************************************************/
+
+static boolean openReplay(const char *name){
+  struct stat info;
+  void *map;
+  int fd = open(name, O_RDONLY);
+
+  if((fd < 0)||(fstat(fd, &info) != 0)){
+    perror(name);
+    return false;
+  }
+  map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED){
+    perror(name);
+    return false;
+  }
+  replayMap = (const byte *)map;
+  replayBytes = info.st_size;
+  return true;
+}
+
+/*************************************************************************/
+/*                                numbered                               */
+/*                                ********                               */
+/*                                                                       */
+/* parameters: out, a buffer of NAMESIZE for the name                    */
+/*             name, a name given on the command line, or NULL           */
+/*             i, the number of the float                                */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function makes the name of the link or EEPROM file of a float,   */
+/* the name itself with one float, the name and the float number with    */
+/* more.                                                                 */
+/*                                                                       */
+/*************************************************************************/
+
+static void numbered(char *out, const char *name, int i){
+  out[0] = '\0';
+  if(name == NULL){
+    return;
+  }
+  if(nFloats == 1){
+    snprintf(out, NAMESIZE, "%s", name);
+  }
+  else{
+    snprintf(out, NAMESIZE, "%s%d", name, i);
+  }
+}
+
+static void stop(int signal){
+  running = 0;
+}
+
+/*************************************************************************/
+/*                                  main                                 */
+/*                                  ****                                 */
+/*                                                                       */
+/* Opens the CTD ports and the control file, runs setup for each float,  */
+/* then runs the event loop until quit or a signal: each pass, the loop  */
+/* of each float that isn't ahead of the pace is run once. When none of  */
+/* them are due it waits (at most a ms) for a command or a control line. */
+/*                                                                       */
+/*************************************************************************/
+
+int main(int argc, char **argv){
+  const char *controlName = "apf.ctl";
+  const char *link = NULL;
+  const char *eepromName = NULL;
+  const char *replayName = NULL;
+  const char *storageName = NULL;
+  char name[NAMESIZE];
+  struct epoll_event event, events[16];
+  byte *initial;
+  double wall;
+  int option, ran, poller, i;
+
+  while((option = getopt(argc, argv, "n:c:l:x:s:e:r:d:v")) != -1){
+    switch(option){
+      case 'n':
+        nFloats = atoi(optarg);
+        break;
+      case 'c':
+        controlName = optarg;
+        break;
+      case 'l':
+        link = optarg;
+        break;
+      case 'x':
+        clockPace = atof(optarg);
+        break;
+      case 's':
+        clockStep = strtoul(optarg, NULL, 10);
+        break;
+      case 'e':
+        eepromName = optarg;
+        break;
+      case 'r':
+        replayName = optarg;
+        break;
+      case 'd':
+        storageName = optarg;
+        break;
+      case 'v':
+        serialDebug = true;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n floats] [-c control] [-l link] [-x pace] [-s step us] [-e eeprom] [-r replay] [-d sd card] [-v]\n", argv[0]);
+        return 2;
+    }
+  }
+  if(clockStep == 0){
+    clockStep = 1;
+  }
+  if(nFloats < 1){
+    nFloats = 1;
+  }
+  if((replayName != NULL)&&!openReplay(replayName)){
+    return 1;
+  }
+
+  //every float starts from the sketch's globals as they are before setup
+  dataSize = __stop_sketch_data - __start_sketch_data;
+  bssSize = __stop_sketch_bss - __start_sketch_bss;
+  initial = new byte[dataSize + bssSize];
+  memcpy(initial, __start_sketch_data, dataSize);
+  memcpy(initial + dataSize, __start_sketch_bss, bssSize);
+
+  floats = new Float[nFloats]();
+  poller = epoll_create1(0);
+  for(i = 0; i < nFloats; i++){
+    floats[i].state = new byte[dataSize + bssSize];
+    memcpy(floats[i].state, initial, dataSize + bssSize);
+    floats[i].ctdBaud = 9600;
+    floats[i].ctdRoom = CTDBUFFERSIZE;
+    floats[i].piston = 1023;
+    numbered(floats[i].link, link, i);
+    numbered(name, eepromName, i);
+    if(name[0] != '\0'){
+      floats[i].eeprom.open(strdup(name));
+    }
+    numbered(floats[i].storageDir, storageName, i);
+    if(floats[i].storageDir[0] != '\0'){
+      mkdir(floats[i].storageDir, 0755);
+    }
+    memset(floats[i].storageFd, -1, sizeof(floats[i].storageFd));
+    if(!openCtd(&floats[i])){
+      return 1;
+    }
+    event.events = EPOLLIN;
+    event.data.u32 = i;
+    epoll_ctl(poller, EPOLL_CTL_ADD, floats[i].ctdMaster, &event);
+  }
+  if(!openControl(controlName)){
+    return 1;
+  }
+  event.events = EPOLLIN;
+  event.data.u32 = nFloats;
+  epoll_ctl(poller, EPOLL_CTL_ADD, controlFd, &event);
+  controlled = &floats[0];
+  fflush(stdout);
+
+  signal(SIGINT, stop);
+  signal(SIGTERM, stop);
+  clock_gettime(CLOCK_MONOTONIC, &wallStart);
+
+  for(i = 0; i < nFloats; i++){
+    runFloat(&floats[i]);
+    setup();
+  }
+  while(running){
+    readControl();
+    ran = 0;
+    wall = wallMicros()*clockPace;
+    for(i = 0; i < nFloats; i++){
+      if((clockPace > 0)&&(nFloats > 1)&&(floats[i].clockNow > wall)){
+        continue;
+      }
+      runFloat(&floats[i]);
+      loop();
+      advanceClock(clockStep);
+      floats[i].passes++;
+      ran++;
+    }
+    if(ran == 0){
+      epoll_wait(poller, events, 16, 1);
+    }
+  }
+
+  for(i = 0; i < nFloats; i++){
+    if(floats[i].link[0] != '\0'){
+      unlink(floats[i].link);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,6902 @@
+/*************************************************************************/
+/*                                APFSim.h                               */
+/*                                ********                               */
+/*                                                                       */
+/* Written by: Sean P. Murphy                                            */
+/*                                                                       */
+/* Version [1.0] supports simulation of APF-9 and APF-11. Currently      */
+/* will support getting P, T (11 only), PT, or PTS readings; querrying   */
+/* firmware / serial number (9 only); configuration; continuous profile, */
+/* binaverage; ice avoidance; displaying calibration coefficients.       */
+/*                                                                       */
+/* The simulator itself, shared by every sketch. A sketch is the         */
+/* variant it simulates (variant.h) and an include of this file, which   */
+/* has the whole program (setup and loop), so it is included once.       */
+/*                                                                       */
+/*************************************************************************/
+
+
+
+
+/*************************************************************************/
+/*                               variant.h                               */
+/*                               *********                               */
+/*                                                                       */
+/* Includes the traits of the controller and seabird being simulated     */
+/*                                                                       */
+/*************************************************************************/
+
+#include "variant.h"
+
+/*************************************************************************/
+/*                                 hal.h                                 */
+/*                                 *****                                 */
+/*                                                                       */
+/* Includes the hardware the simulator uses (Serial1, the hardware lines,*/
+/* the piston, the clock and Timer1), so the sketch also builds as a     */
+/* Linux program (see host/)                                             */
+/*                                                                       */
+/*************************************************************************/
+
+#include "hal.h"
+
+/*************************************************************************/
+/*                               EEPROM.h                                */
+/*                               ********                                */
+/*                                                                       */
+/* Includes the source code for the EEPROM the baud rate of Serial1 is   */
+/* kept in, comes with the arduino software                              */
+/*                                                                       */
+/*************************************************************************/
+
+#include <EEPROM.h>
+
+/*************************************************************************/
+/*                                  #defines                             */
+/*                                  ********                             */
+/*                                                                       */
+/*************************************************************************/
+
+
+//used to define phase/state of mission
+#define PRESSUREACTIVATION 0
+#define PRELUDE 1
+#define PARKDESCENT 2
+#define PARK 3
+#define DEEPDESCENT 4
+#define ASCENTTOPARK 5
+#define ASCENTTOSURFACE 6
+#define SURFACE 7
+
+//the mission schedule has a step for each phase from prelude to surface, the pressure of a
+//step is in fixed point with SCHEDULESHIFT fraction bits
+#define MISSIONSTEPS (SURFACE - PRELUDE + 1)
+#define SCHEDULESHIFT 32
+
+//used to define the type of message to send back as a result of a request
+//over the hardware toggle lines, PTSO is a PTS request answered with oxygen (HAS_OXYGEN)
+#define SERNO 1
+#define PTS 2
+#define PT 3
+#define P 4
+#define PTSO 5
+
+//used to decode a request over the hardware lines, the lines are sampled once every
+//LINETICK us, the request line is checked LINEWAIT ticks after it rises, then the Rx
+//and mode lines are sampled LINEVOTES times and are high if LINEHIGH of them are high
+#define LINETICK 50000
+#define LINEWAIT 4
+#define LINEVOTES 6
+#define LINEHIGH 2
+
+//used to define the different options for ice detection
+#define NOICE -1
+#define ICEDETECT 1
+#define ICECAP 2
+#define ICEBREAKUP 3
+
+//used to define the water column, temperature and salinity are looked up every WATERSTEP
+//hundredths of a dbar (50 dbar) in waterColumn, and every ICESTEP (5 dbar) down to ICEDEPTH
+//in the ice overlay
+#define WATERSTEP 5000
+#define ICESTEP 500
+#define ICEDEPTH 5000
+#define ICEPOINTS (ICEDEPTH/ICESTEP + 1)
+
+//used to define the commands to set the mission parameters
+#define DOWNTIME "Mtd"
+#define ASCENTTIMEOUT "Mta"
+#define DEEPPROFILEDESCENTTIME "Mtj"
+#define PARKDESCENTTIME "Mtk"
+#define PRELUDETIME "Mtp"
+#define PARKPRESSURE "Mk"
+#define DEEPPROFILEPRESSURE "Mj"
+#define MISSIONTIME "i*t"
+#define DOWNTIME2 "mtd"
+#define ASCENTTIMEOUT2 "mta"
+#define DEEPPROFILEDESCENTTIME2 "mtj"
+#define PARKDESCENTTIME2 "mtk"
+#define PRELUDETIME2 "mtp"
+#define PARKPRESSURE2 "mk"
+#define DEEPPROFILEPRESSURE2 "mj"
+
+#define OFF -69
+
+//used to define how a command from the APFx is read, see the command table
+//ARG_NONE: the command is complete on the carriage return
+//ARG_NUMBER: the name is complete on its own, a number follows up to the carriage return
+//ARG_NAME: the name is complete on its own, a name follows up to the carriage return
+//ARG_NOW: the name is complete on its own and nothing follows
+#define ARG_NONE 0
+#define ARG_NUMBER 1
+#define ARG_NAME 2
+#define ARG_NOW 3
+
+//used to define when a command is ignored
+#define CMD_ANYTIME 0
+#define CMD_NOTCP 1
+
+//used to define the longest command name (plus the null) and the longest value after a command
+#define CMDNAMELEN 24
+#define ARGBUFFSIZE 32
+
+//used to define the size of the buffer a single reply line (a P, T, S sample or a bin) is built in
+#define REPLYSIZE 48
+
+//used to define which bulk upload (or long reply) is being sent, if any
+#define UPLOAD_NONE 0
+#define UPLOAD_DD 1
+#define UPLOAD_DA 2
+#define UPLOAD_DAH 3
+#define UPLOAD_DAB 4
+#define UPLOAD_TRACE 5
+#define UPLOAD_FLASH 6
+#define UPLOAD_STATS 7
+#define UPLOAD_SCHED 8
+
+//used to define the values a flash reply (writeFlash) is sent with: the most numbers, the
+//room for its texts (with their nulls), and the room a record leaves for the longest field
+//(a long or a text of 13 characters)
+#define UPLOADNUMBERS 10
+#define UPLOADTEXTSIZE 24
+#define UPLOADFIELDSIZE 14
+
+//number of bytes in a bin of the binary upload (dab)
+#define BINRECORDSIZE 7
+
+//number of events the trace keeps (a new event replaces the oldest once it is full) and
+//the number of bytes of an event in the trace upload (dumptrace)
+#define TRACESIZE 64
+#define TRACERECORDSIZE 7
+
+//used to define the events in the trace
+#define TRACE_RX 1
+#define TRACE_TX 2
+#define TRACE_LINE 3
+#define TRACE_PHASE 4
+#define TRACE_PISTON 5
+#define TRACE_BAUD 6
+
+//used to define the statistics kept by stats: the commands and requests that get their own
+//row (the rest share the last, "other"), the buckets of the histograms (bucket b counts the
+//values under first*4^b, the last one the rest), where the first latency (us) and reply
+//size (bytes) buckets end, and the keys of the hardware line requests (STATSLINE + SERNO...)
+//and of the other row
+#define STATSROWS 12
+#define STATSBUCKETS 6
+#define STATSLATENCY 1000
+#define STATSBYTES 8
+#define STATSLINE 1000
+#define STATSOTHER -1
+
+//used to define where the statistics stop counting: a row stops once its count would pass
+//STATSCOUNTMAX (or a sum would wrap), a histogram bucket stays at STATSBUCKETMAX once there
+#define STATSCOUNTMAX 65535
+#define STATSBUCKETMAX 255
+
+//the number of parts the stats reply sends each row in (statsToRecord)
+#define STATSPARTS 5
+
+//used to define the recorded profile (replay, made by replay.py): the header of the file
+//("APFR", version, record size, number of records, flags) is REPLAYHEADERSIZE bytes, the
+//records are read REPLAYWINDOW at a time, and REPLAY_OXYGEN is the flag of a profile with O2
+#define REPLAYVERSION 1
+#define REPLAYHEADERSIZE 16
+#define REPLAYWINDOW 8
+#define REPLAY_OXYGEN 1
+
+//used to define the sensor noise model (noise): the channels it adds noise to, the spread
+//of the sum of 4 random bytes (its standard deviation, so the sum times sigma/NOISESPREAD
+//has about sigma), how many sigmas a spike is, and the largest sigma (in the units of the
+//channel) and rate (per thousand samples) that can be set
+#define NOISE_P 0
+#define NOISE_T 1
+#define NOISE_S 2
+#define NOISE_O 3
+#define NOISECHANNELS 4
+#define NOISESPREAD 148
+#define NOISESPIKEGAIN 20
+#define NOISESIGMAMAX 100000
+#define NOISERATEMAX 1000
+
+//used to define the SBE43F oxygen sensor (HAS_OXYGEN): its time constant at 20 C and 0 dbar
+//(TAU_20 of dc, hundredths of a sec), the pressure and temperature corrections of it, the
+//limits on it and on the pump time (sec) as Sbe43PumpTime in sbe41.c has them, and the
+//largest Nf and Ns (tenths) that can be set
+#define OXYGENTAU20 275
+#define OXYGENPCOR 1.964e-4
+#define OXYGENTCOR -4.1776e-2
+#define OXYGENTAUMIN 2.0
+#define OXYGENTAUMAX 30.0
+#define OXYGENPUMPMIN 7
+#define OXYGENPUMPMAX 100
+#define OXYGENNMAX 100
+
+//used to define the files recorded to the SD card (STORE_CP the continuous profile samples,
+//STORE_TRACE the trace events), how many STORAGEBLOCK byte blocks each is made (1 MB is
+//~17 hours of samples) and the size of their records. every block starts with a
+//STOREHEADERSIZE byte header (run, block, records, record size)
+#define STORE_CP 0
+#define STORE_TRACE 1
+#define STORECPBLOCKS 2048
+#define STORETRACEBLOCKS 512
+#define STORECPRECORDSIZE 16
+#define STORETRACERECORDSIZE 8
+#define STOREHEADERSIZE 8
+
+//used to define how often (ms) the store job looks for a full block to write, how long (ms)
+//before a continuous profile sample it won't start one, and where the run number (counted up
+//each time the simulator starts, so the runs in a file can be told apart) is kept in the EEPROM
+#define STOREPERIOD 50
+#define STOREGUARD 100
+#define STOREADDRESS 4
+
+//used to define how many trace events waiting in traceRing make a block of TRACE.BIN (the
+//ring holds TRACESIZE, the rest leave time for the block before) and how many blocks of zeros
+//the store job adds to a file that isn't its full size yet each time it runs while idle
+#define STORETRACEBATCH 48
+#define STOREGROWBLOCKS 2
+
+//used to define the size of the Serial1 receive ring buffer and how long (ms) the APFx
+//has between the characters of a command name
+#define RXBUFFERSIZE 128
+#define RXTIMEOUT 3000
+
+//used to define the longest reply a command leaves to be sent later (replyLater), the prompt
+//and the echo of the command with its value
+#define LATERSIZE (4+CMDNAMELEN+ARGBUFFSIZE)
+
+//size of the ring buffer replies wait in to be sent over Serial1, can be made bigger
+//if there is RAM to spare. The replies longer than this (ds, dc, ?, i*l, stats, sched) are
+//uploads, sent a record at a time as it empties, so nothing waits for it
+#define TXBUFFERSIZE 256
+
+//most bins kept for binaverage, da and dah (13 bytes each), samples deeper than the last
+//bin are counted but not averaged, and a bin stops at 255 samples (the most dah can show)
+#define MAXBINS 128
+#define MAXBINSAMPLES 255
+
+//used to define the baud rate of Serial1, the SBE41 rate is BAUDDEFAULT. a new rate (baud=<val>)
+//has to be confirmed by a command at that rate within BAUDTIMEOUT ms or Serial1 goes back to
+//BAUDDEFAULT, a confirmed rate is kept in the EEPROM at BAUDADDRESS and used after a reset
+#define BAUDDEFAULT 9600
+#define BAUDTIMEOUT 10000
+#define BAUDADDRESS 0
+
+//used to define the fastest the mission clock can run (timescale=<val>), at TIMESCALEMAX a
+//default mission cycle (~1.3 days) takes ~11 sec
+#define TIMESCALEMAX 10000
+
+//used to define the jobs run by the scheduler (the rows of jobs)
+#define JOB_PISTON 0
+#define JOB_PHASE 1
+#define JOB_SERNO 2
+#define JOB_REPLAY 3
+#define JOB_STORE 4
+#define JOB_OXYGEN 5
+#define JOB_REPLY 6
+#define JOB_CP 7
+#define JOB_PROFILESTART 8
+
+//used to define the state of a change to the baud rate
+#define BAUD_SET 0
+#define BAUD_SWITCH 1
+#define BAUD_CONFIRM 2
+
+/*************************************************************************/
+/*                             global variables                          */
+/*                             ****************                          */
+/*                                                                       */
+/* interruptMessage: an int that represents which message to send based  */
+/*                  on the toggling of the hardware lines                */
+/*                                                                       */
+/* lineTicks: an int that represents how many ticks of Timer1 since the  */
+/*                  request line rose, a negative value means no request */
+/*                  is being decoded                                     */
+/*                                                                       */
+/* rxVotes, modeVotes: bytes that represent how many of the samples of   */
+/*                  the Rx line (19) and the mode line (3) were high     */
+/*                                                                       */
+/* cpMode: an int that represents whether the simulator is in continuous */
+/*                  profiling, a negative value means no (default)       */
+/*                                                                       */
+/* cpStopReply: a boolean that represents whether "profile stopped" is   */
+/*                  waiting for an upload to finish                      */
+/*                                                                       */
+/* count: an int that represents the number of samples taken while in    */
+/*                  continuous profile mode                              */
+/*                                                                       */
+/* maxPress, minPress: float values that represent that max and min      */
+/*                  pressure calculated during continuous profiling      */
+/*                                                                       */
+/* nBins, samplesLeft, samplesused: int values that represent the total  */
+/*                  number of bins (down to the deepest one with         */
+/*                  samples), the number of samples left after           */
+/*                  subtracting the samples used for one bin, and the    */
+/*                  the number of samples used in a single bin           */
+/*                                                                       */
+/* da: an int that represents whether a bin average has been taken, if a */
+/*                  binaverage hasn't been calculated, it's -1 (default) */
+/*                                                                       */
+/* inc: an int that represents the next bin to be sent by binaverage, is  */
+/*                  incremented in the binaverage function then reset    */
+/*                  after dumping the data from the profile              */
+/*                                                                       */
+/* bins: the running sums of the samples of continuous profiling that    */
+/*                  fell in each bin, and how many there were            */
+/*                                                                       */
+/* topBinInterval, topBinSize, topBinMax, middleBinInterval,             */
+/* middleBinSize, middleBinMax, bottomBinInterval, bottomBinSize: ints   */
+/*                  that represent the bin settings (dbar) sent by the   */
+/*                  APFx, bins start every interval and are size wide,   */
+/*                  the top bins go down to top max and the middle bins  */
+/*                  to middle max                                        */
+/*                                                                       */
+/* readingPressure, readingTemperature, readingSalinity: longs that      */
+/*                  represent the last reading made by                   */
+/*                  getReadingFromPiston or getDynamicReading            */
+/*                                                                       */
+/* msg: the string sent over serial to the APFx for the serial number    */
+/*                                                                       */
+/* pOrPTS: an array of strings that determine whether the output is just */
+/*                  a p reading or a pts reading, necessary to pass test */
+/*                  during configuration                                 */
+/*                                                                       */
+/* pOrPTSsel: an int that represents the array index for the pOrPTS      */
+/*                  array, 1 (default) means PTS, 0 means P. this will   */
+/*                  be changed based on serial messages received from    */
+/*                  APF board                                            */
+/*                                                                       */
+/* iceAvoidance: an int that represents which ice avoidance protocol is  */
+/*                  in effect, -1:none, 1:detect, 2:cap, 3:breakup       */
+/*                                                                       */
+/* icePressure: an int that represents the pressure at which ice will be */
+/*                  detected, set by typing one of ice (id/b/c) commands */
+/*                                                                       */
+/* iceTemperature, iceSalinity: arrays of longs that represent the water */
+/*                  column of the ice avoidance mode in effect, every    */
+/*                  ICESTEP from the surface, rebuilt by buildIceOverlay */
+/*                                                                       */
+/* iceLimit: a long that represents the pressure (hundredths of a dbar)  */
+/*                  the ice overlay is used above, 0 when there isn't    */
+/*                  one                                                  */
+/*                                                                       */
+/* missionMode: an int that represents whether the simulator should be   */
+/*                  simulating a mission, 0: no mission, 100>=: mission  */
+/*                                                                       */
+/* currentPosition, lastPosition: ints that represent the current  and   */
+/*                  previous values being read from the piston pot       */
+/*                                                                       */
+/* currentPhase, lastPhase: ints that represent which phase of the       */
+/*                  mission the is currently being simulated and the     */
+/*                  previous phase that was just simulated, both at      */
+/*                  start (prelude) initially                            */
+/* phase: an array of strings that represent the various phases that a   */
+/*                  mission might be in, used for the UI while running a */
+/*                  mission                                              */
+/*                                                                       */
+/* update, lastUpdate: unsigned long longs that represent the mission    */
+/*                  clock now and the last time that the current mission */
+/*                  time was updated                                     */
+/*                                                                       */
+/* parkPressure, deepProfilePressure: ints that represent the pressures  */
+/*                  expected at different states of the mission          */
+/*                                                                       */
+/* parkDescentTime, parkDescentTimeDisplay, parkDescentTimeCopy: ints    */
+/*                  that represent the time in ms, minutes, and a copy   */
+/*                  in ms, it takes for the float to go through the      */
+/*                  entire park descent                                  */
+/*                                                                       */
+/* downTime, downTimeDisplay, downTimeCopy: long longs (downTimeDisplay  */
+/*                  a long) that represent the time in ms, minutes, and  */
+/*                  a copy in ms, it takes for the float to go through   */
+/*                  the entire park descent, park, and deep profile      */
+/*                  descent phases combined                              */
+/*                                                                       */
+/* deepProfileDescentTime, deepProfileDescentTimeDisplay,                */
+/*                  deepProfileDescentCopy: ints that represent the time */
+/*                  in ms, seconds, and a copy in ms, it takes for the   */
+/*                  float to go through the entire deep profile descent  */
+/*                                                                       */
+/* ascentTimeOut, ascentTimeOutDisplay, ascentTimeOutCopy: ints that     */
+/*                  represent the time in ms, minutes, and a copy in ms, */
+/*                  it takes for the float to go through the ascent      */
+/*                                                                       */
+/* missionTime: a long long representing the mission time (ms) in the    */
+/*                  mission (a long would wrap after 24.8 days), can be  */
+/*                  set manually in sys chat or will be incremented by   */
+/*                  timer automatically every ~5 seconds                 */
+/*                                                                       */
+/* ascentTime: ascentTimeCopy: ints that represent the actual time in ms */
+/*                  that it takes the float to ascend to the surface, it */
+/*                  is based off of the ascent rate and the depth of the */
+/*                  deep profile descent                                 */
+/*          w                                                             */
+/* ascentToPark, ascentToParkCopy: ints that represent the actual time   */
+/*                  in ms that it takes the float to ascent from deep    */
+/*                  profile pressure to park pressure, based on ascent   */
+/*                  time, and the difference between the park pressure   */
+/*                  and the deep profile pressure                        */
+/*                                                                       */
+/* ascentToSurface, ascentToSurfaceCopy: ints that represent the actual  */
+/*                  time in ms that it takes the float to ascent from    */
+/*                  deep profile pressure to park pressure, based on     */
+/*                  ascent time, and the difference between the park     */
+/*                  pressure and the deep profile pressure               */
+/*                                                                       */
+/* ascentRate: an int that represents how quickly a float will ascend in */
+/*                  cm/sec during ascent phase of a mission              */
+/*                                                                       */
+/* cmdLo, cmdHi, cmdLen: bytes that represent the range of commandOrder  */
+/*                  whose names start with the characters received so    */
+/*                  far, and how many characters have been received      */
+/*                                                                       */
+/* cmdMatch: an int that represents the row of the command table whose   */
+/*                  name matches the characters received so far, -1 if   */
+/*                  none does                                            */
+/*                                                                       */
+/* argBuff, argLen: the value received after a command that takes one,   */
+/*                  and its length                                       */
+/*                                                                       */
+/* rxBuffer, rxHead, rxTail: a ring buffer of the characters received on */
+/*                  Serial1 that haven't been fed to the command table   */
+/*                  yet, rxHead is where the next one is stored and      */
+/*                  rxTail is the next one to be read                    */
+/*                                                                       */
+/* rxLast: an unsigned long that represents the time (ms) the last       */
+/*                  character of the current command was received        */
+/*                                                                       */
+/* txBuffer, txHead, txTail: a ring buffer of the bytes waiting to be    */
+/*                  sent over Serial1, txHead is where the next one is   */
+/*                  stored and txTail is the next one to be sent         */
+/*                                                                       */
+/* baudRate, baudNext: longs that represent the baud rate of Serial1 and */
+/*                  the rate it is changing to                           */
+/*                                                                       */
+/* baudState: an int that represents whether the baud rate is set, about */
+/*                  to change or waiting to be confirmed                 */
+/*                                                                       */
+/* baudSince: an unsigned long that represents the time (ms) Serial1     */
+/*                  changed to a rate that hasn't been confirmed         */
+/*                                                                       */
+/* timeScale: a long that represents how many times faster than real     */
+/*                  time the mission clock runs                          */
+/*                                                                       */
+/* clockLast: an unsigned long that represents the time (ms) the mission */
+/*                  clock was last read                                  */
+/*                                                                       */
+/* clockTotal: an unsigned long long that represents the mission clock   */
+/*                  (ms) when it was last read                           */
+/*                                                                       */
+/* clockPaused: a boolean that represents whether the mission is paused, */
+/*                  the mission clock doesn't run while it is            */
+/*                                                                       */
+/* uploadType: an int that represents the bulk upload (dd, da, dah, dab) */
+/*                  or long reply (a flash reply, stats, sched) being    */
+/*                  sent, UPLOAD_NONE when there isn't one               */
+/*                                                                       */
+/* uploadIndex, uploadCount: ints that represent the next record of the  */
+/*                  upload (-1 is the header, uploadCount the trailer)   */
+/*                  and the number of samples or bins in it              */
+/*                                                                       */
+/* uploadIncrement: a float that represents the pressure between two     */
+/*                  samples of a dd upload                               */
+/*                                                                       */
+/* uploadRecord, uploadPos, uploadLen: the record being sent, how many   */
+/*                  of its bytes have been sent and how many there are   */
+/*                                                                       */
+/* uploadEncoder: the function that writes the bins of a da, dah or dab  */
+/*                  upload (binToAscii, binToHex or binToBinary)         */
+/*                                                                       */
+/* uploadCrc: an unsigned int that represents the CRC of the binary part */
+/*                  of a dab or dumptrace upload sent so far             */
+/*                                                                       */
+/* uploadFlash: the next character of a flash reply, NULL once the null  */
+/*                  at its end is sent                                   */
+/*                                                                       */
+/* uploadNumbers, uploadTexts, uploadText: copies of the values of the   */
+/*                  fields of a flash reply (the texts one after the     */
+/*                  other with their nulls) and the next text            */
+/*                                                                       */
+/* traceRing: the last TRACESIZE events (commands, replies, requests on  */
+/*                  the hardware lines, phase changes, piston readings)  */
+/*                  with the time (ms) each happened                     */
+/*                                                                       */
+/* traceHead, traceCount: bytes that represent where the next event goes */
+/*                  in traceRing and how many events it holds            */
+/*                                                                       */
+/* stats, statsUsed: the latency and reply size statistics of each       */
+/*                  command and hardware line request, and how many of   */
+/*                  its rows are in use (40 bytes a row on the Mega)     */
+/*                                                                       */
+/* statsSince: an unsigned long that represents the time (ms) the        */
+/*                  statistics were last reset                           */
+/*                                                                       */
+/* statsKey, statsStart, statsFirst, statsBytes: the request being       */
+/*                  measured (its command row or STATSLINE + request),   */
+/*                  the time (us) it was received, the time (us) the     */
+/*                  first byte of its reply went to Serial1 and how many */
+/*                  bytes were queued for it                             */
+/*                                                                       */
+/* statsWaiting: a boolean that represents whether the first byte of the */
+/*                  reply is yet to go to Serial1                        */
+/*                                                                       */
+/* lineRise: an unsigned long that represents the time (us) the request  */
+/*                  line last rose                                       */
+/*                                                                       */
+/* schedule: the phases of the mission in the order they come, with the  */
+/*                  mission time (ms) each starts at and its pressure    */
+/*                  over time, rebuilt by buildMissionSchedule whenever  */
+/*                  a mission parameter changes                          */
+/*                                                                       */
+/* scheduleAt: a byte that represents the step of schedule the last      */
+/*                  lookup found, the next one starts from it            */
+/*                                                                       */
+/* replayBuffer: the two windows of the recorded profile in SRAM, one    */
+/*                  being sampled while the next is read into the other  */
+/*                                                                       */
+/* replayWindow, replayWindowNo, replayWindowLen: where the records of   */
+/*                  each buffer are (the buffer, or the file itself on   */
+/*                  Linux), which window they are (-1 for none) and how  */
+/*                  many records it has                                  */
+/*                                                                       */
+/* replayCount, replayWindows: longs that represent the number of        */
+/*                  records and windows in the recorded profile, 0 when  */
+/*                  there isn't one                                      */
+/*                                                                       */
+/* replayAt: a byte that represents the buffer the last sample came from */
+/*                                                                       */
+/* replayNext: a long that represents the window the replay job reads in */
+/*                  next, -1 for none                                    */
+/*                                                                       */
+/* replayPressure: a long that represents the pressure of the last       */
+/*                  sample, which way it moves picks the next window     */
+/*                                                                       */
+/* replayOn, replayOxygen: booleans that represent whether samples come  */
+/*                  from the recorded profile and whether it has O2      */
+/*                                                                       */
+/* replayMisses: an unsigned int that represents how many samples had to */
+/*                  wait for their window to be read                     */
+/*                                                                       */
+/* storeBuffers: the block CP.BIN is filled in and a spare, a full block */
+/*                  is swapped for the spare and written from it by the  */
+/*                  store job. TRACE.BIN has no block of its own, its    */
+/*                  events wait in traceRing and are put in the spare    */
+/*                                                                       */
+/* stores: the files recorded to the SD card, with the block each is     */
+/*                  filling (NULL for TRACE.BIN), the next block of the  */
+/*                  file it goes to and how many blocks the file has     */
+/*                                                                       */
+/* storeSpare, storeFull: the block that is free to be filled next, and  */
+/*                  the full block waiting to be written (NULL if none)  */
+/*                                                                       */
+/* storeFullStore, storeFullBlock: the store the full block is from and  */
+/*                  the block of its file it goes to                     */
+/*                                                                       */
+/* storeRun: an unsigned int that represents the run number written in   */
+/*                  every block                                          */
+/*                                                                       */
+/* storeSync: a boolean that represents whether the blocks that are      */
+/*                  partly filled are to be written too                  */
+/*                                                                       */
+/* storeTraceWaiting: a byte that represents how many of the newest      */
+/*                  events in traceRing are yet to go to TRACE.BIN       */
+/*                                                                       */
+/* noiseSeed, noiseState: the seed of the noise model and the state of   */
+/*                  its random numbers (xorshift, 32 bit on the Mega and */
+/*                  on Linux, so a seed gives the same run on both)      */
+/*                                                                       */
+/* noiseSigma: longs that represent the standard deviation of the noise  */
+/*                  of each channel (hundredths of a dbar, ten           */
+/*                  thousandths of a degree C or PSU, Hz)                */
+/*                                                                       */
+/* noiseSpike, noiseDropout: longs that represent how many samples in a  */
+/*                  thousand get a spike and drop out                    */
+/*                                                                       */
+/* noiseOn: a boolean that represents whether any noise is set, so the   */
+/*                  samples without it cost a single test                */
+/*                                                                       */
+/* noiseSpikes, noiseDropouts: unsigned longs that represent how many    */
+/*                  spikes and dropouts there have been                  */
+/*                                                                       */
+/* laterReply: a char buffer of LATERSIZE that holds the echo of the     */
+/*                  last command until the reply job sends it            */
+/*                                                                       */
+/* laterAttach: a boolean that represents if the reply job reattaches    */
+/*                  the interrupt to pin2 after it (qsr)                 */
+/*                                                                       */
+/* oxygenNf, oxygenNs: longs that represent the Nf and Ns of the SBE43F  */
+/*                  (tenths, oxnf= and oxns=), a PTS request is answered */
+/*                  with oxygen after the pump once Nf is set            */
+/*                                                                       */
+/* oxygenReply: a char buffer of REPLYSIZE that holds the PTSO sample    */
+/*                  while the pump runs (the oxygen job sends it)        */
+/*                                                                       */
+/* oxygenPump, oxygenPumpTotal: unsigned longs that represent the pump   */
+/*                  time (ms) of the last PTSO sample and of all of them */
+/*                                                                       */
+/* oxygenSamples: an unsigned long that represents how many PTSO samples */
+/*                  have been taken                                      */
+/*                                                                       */
+/*************************************************************************/
+
+volatile int interruptMessage = 0;
+volatile int lineTicks = -1;
+volatile byte rxVotes = 0, modeVotes = 0;
+int cpMode;
+boolean cpStopReply = false;
+int count = 0;
+
+float maxPress = 0;
+float minPress = 10000;
+
+int nBins = 0;
+int samplesLeft;
+int da = -1;
+
+int inc = 0;
+
+struct Bin {
+  long pressure;
+  long temperature;
+  long salinity;
+  byte samples;
+};
+
+Bin bins[MAXBINS];
+
+//writes one bin for an upload (average P, T, S and number of samples) and returns how many
+//bytes of it to send
+typedef int (*BinEncoder)(char *, long, long, long, int);
+
+int topBinInterval = 2, topBinSize = 2, topBinMax = 10;
+int middleBinInterval = 2, middleBinSize = 2, middleBinMax = 20;
+int bottomBinInterval = 2, bottomBinSize = 2;
+
+long readingPressure = 0, readingTemperature = 0, readingSalinity = 0;
+
+const char *msg = CTDID;
+
+const char *pOrPTS[2] = {"P only", "PTS"};
+
+int pOrPTSsel = 1;
+
+//the SBE41 STD settings shown by ds, changed by pumpfastpt, outputdensity and addtimingdelays
+const char *pumpFast[2] = {"do not pump", "pump 0.25 sec"};
+
+const char *noOrYes[2] = {"no", "yes"};
+
+int pumpFastSel = 0, outputDensitySel = 0, addDelaysSel = 0;
+
+int iceAvoidance = -1;
+
+int icePressure = 20;
+
+long iceTemperature[ICEPOINTS], iceSalinity[ICEPOINTS];
+
+long iceLimit = 0;
+
+int missionMode = 0;
+
+int currentPosition = 0, lastPosition = 0;
+
+int currentPhase = PRESSUREACTIVATION, lastPhase = PRESSUREACTIVATION;
+
+const char *phase[8]={"Pressure Activation","Prelude","Park Descent","Park","Deep Profile Descent","Ascent","Ascent","Surface"};
+
+unsigned long long lastUpdate = 0, update = 0;
+
+int parkPressure = PARKPRESSUREDEFAULT, deepProfilePressure = DEEPPROFILEPRESSUREDEFAULT;
+
+long prelude = -1, preludeDisplay = 200;
+
+long parkDescentTime = 18000000, parkDescentTimeCopy = 18000000, parkDescentTimeDisplay = 300;
+
+long long downTime = 86400000, downTimeCopy = 86400000;
+long downTimeDisplay = 1440;
+
+long deepProfileDescentTime = 18000000, deepProfileDescentTimeCopy = 18000000, deepProfileDescentTimeDisplay = 300;
+
+long ascentTimeOut = 36000000, ascentTimeOutCopy = 36000000, ascentTimeOutDisplay = 600;
+
+long long missionTime = 0, missionTimeCopy = 0;
+long missionTimeDisplay = 0;
+
+long phaseChange = 0, newTimeDisplay;
+long long newTime;
+
+long ascentTime = 25000000, ascentTimeCopy = 25000000;
+
+long ascentToPark = 12500000, ascentToParkCopy = 12500000;
+
+long ascentToSurface = 12500000, ascentToSurfaceCopy = 12500000;
+
+int ascentRate = 8;
+
+//a step of the mission schedule: the phase, the mission time (ms) it starts at, and its
+//pressure (hundredths of a dbar) at the mission time origin and how it changes per ms
+//(slope, SCHEDULESHIFT fraction bits)
+struct MissionStep {
+  byte phase;
+  long long start;
+  long long origin;
+  long pressure;
+  long long slope;
+};
+
+MissionStep schedule[MISSIONSTEPS];
+
+byte scheduleAt = 0;
+
+int constantP, constant = -1;;
+
+byte cmdLo = 0, cmdHi = 0, cmdLen = 0;
+
+int cmdMatch = -1;
+
+char argBuff[ARGBUFFSIZE];
+
+byte argLen = 0;
+
+char rxBuffer[RXBUFFERSIZE];
+
+byte rxHead = 0, rxTail = 0;
+
+unsigned long rxLast = 0;
+
+byte txBuffer[TXBUFFERSIZE];
+
+unsigned int txHead = 0, txTail = 0;
+
+long baudRate = BAUDDEFAULT, baudNext = BAUDDEFAULT;
+
+int baudState = BAUD_SET;
+
+unsigned long baudSince = 0;
+
+long timeScale = 1;
+
+unsigned long clockLast = 0;
+
+unsigned long long clockTotal = 0;
+
+boolean clockPaused = false;
+
+int uploadType = UPLOAD_NONE;
+
+int uploadIndex = 0, uploadCount = 0;
+
+float uploadIncrement = 0;
+
+char uploadRecord[REPLYSIZE];
+
+byte uploadPos = 0, uploadLen = 0;
+
+BinEncoder uploadEncoder = NULL;
+
+unsigned int uploadCrc = 0;
+
+const char *uploadFlash = NULL;
+
+long uploadNumbers[UPLOADNUMBERS];
+
+char uploadTexts[UPLOADTEXTSIZE];
+
+const char *uploadText = uploadTexts;
+
+struct TraceEvent {
+  unsigned long time;
+  byte type;
+  unsigned int data;
+};
+
+TraceEvent traceRing[TRACESIZE];
+
+byte traceHead = 0, traceCount = 0;
+
+struct CommandStats {
+  int key;
+  unsigned int count;
+  unsigned long latencyMin, latencyMax, latencySum;
+  unsigned long bytesMin, bytesMax, bytesSum;
+  byte latencyHistogram[STATSBUCKETS];
+  byte bytesHistogram[STATSBUCKETS];
+};
+
+CommandStats stats[STATSROWS];
+
+byte statsUsed = 0;
+
+unsigned long statsSince = 0;
+
+int statsKey = STATSOTHER;
+
+unsigned long statsStart = 0, statsFirst = 0, statsBytes = 0;
+
+boolean statsWaiting = false;
+
+volatile unsigned long lineRise = 0;
+
+struct ReplayRecord {
+  int32_t pressure;
+  int32_t temperature;
+  int32_t salinity;
+  int32_t oxygen;
+};
+
+ReplayRecord replayBuffer[2][REPLAYWINDOW];
+
+const ReplayRecord *replayWindow[2] = {NULL, NULL};
+
+long replayWindowNo[2] = {-1, -1};
+
+byte replayWindowLen[2] = {0, 0};
+
+long replayCount = 0, replayWindows = 0;
+
+byte replayAt = 0;
+
+long replayNext = -1;
+
+long replayPressure = 0;
+
+boolean replayOn = false, replayOxygen = false;
+
+unsigned int replayMisses = 0;
+
+struct Store {
+  const char *name;
+  unsigned long blocks;
+  byte recordSize;
+  boolean open;
+  unsigned long next;
+  byte *fill;
+  int fillLen;
+  unsigned long written;
+  unsigned long dropped;
+  unsigned long allocated;
+};
+
+byte storeBuffers[2][STORAGEBLOCK];
+
+Store stores[STORAGEFILES] = {
+  {"CP.BIN",    STORECPBLOCKS,    STORECPRECORDSIZE,    false, 0, storeBuffers[0], STOREHEADERSIZE, 0, 0, 0},
+  {"TRACE.BIN", STORETRACEBLOCKS, STORETRACERECORDSIZE, false, 0, NULL,            STOREHEADERSIZE, 0, 0, 0},
+};
+
+byte *storeSpare = storeBuffers[1], *storeFull = NULL;
+
+byte storeFullStore = 0;
+
+unsigned long storeFullBlock = 0;
+
+unsigned int storeRun = 0;
+
+boolean storeSync = false;
+
+byte storeTraceWaiting = 0;
+
+uint32_t noiseSeed = 1, noiseState = 1;
+
+long noiseSigma[NOISECHANNELS] = {0, 0, 0, 0};
+
+long noiseSpike = 0, noiseDropout = 0;
+
+boolean noiseOn = false;
+
+unsigned long noiseSpikes = 0, noiseDropouts = 0;
+
+char laterReply[LATERSIZE];
+
+boolean laterAttach = false;
+
+long oxygenNf = 0, oxygenNs = 0;
+
+char oxygenReply[REPLYSIZE];
+
+unsigned long oxygenPump = 0, oxygenPumpTotal = 0;
+
+unsigned long oxygenSamples = 0;
+
+/*************************************************************************/
+/*                            function prototypes                        */
+/*                            *******************                        */
+/*                                                                       */
+/*************************************************************************/
+
+void getReadingFromPiston(int, char *);
+
+void getDynamicReading(int, char *);
+
+char *readingToChars(char *, int, long, long, long, long);
+
+char *pressureToChars(char *, long);
+
+char *tempOrSalinityToChars(char *, long);
+
+char *longToChars(char *, long);
+
+char *longLongToChars(char *, long long);
+
+char *digitsToChars(char *, unsigned long, byte);
+
+char *hexToChars(char *, unsigned long, byte);
+
+char *appendChars(char *, const char *);
+
+int binaverage(char *, BinEncoder);
+
+int binToAscii(char *, long, long, long, int);
+
+int binToHex(char *, long, long, long, int);
+
+int binToBinary(char *, long, long, long, int);
+
+unsigned int crc16(unsigned int, const byte *, int);
+
+void trace(byte, unsigned int);
+
+int traceToBinary(char *, int);
+
+int flashToRecord(char *);
+
+int statsToRecord(char *);
+
+int schedToRecord(char *);
+
+void startStores(void);
+
+void putLong(byte *, unsigned long);
+
+void storeRecord(byte, const byte *);
+
+void storeSample(long, long, long);
+
+void storeBlock(byte);
+
+void storeTrace(void);
+
+void storeGrow(void);
+
+boolean storeIdle(void);
+
+void startStats(int, unsigned long);
+
+void endStats(void);
+
+int statsRow(int);
+
+byte statsBucket(unsigned long, unsigned long);
+
+long parseValue(const char *);
+
+void checkLine(void);
+
+void lineTick(void);
+
+void checkPistonSurface(void);
+
+void checkPistonPrelude(void);
+
+void checkPistonPark(void);
+
+void checkPistonAscent(void);
+
+void continuousProfile(void);
+
+void buildIceOverlay(void);
+
+void setAscentTimes(void);
+
+void buildMissionSchedule(void);
+
+void setMissionStep(int, byte, long long, long, long, long long, long);
+
+int missionStep(long long);
+
+long missionPressure(long long);
+
+void getWaterSample(long, long *, long *, long *);
+
+long getOxygenSample(long);
+
+boolean startReplay(void);
+
+long replayRecordPressure(long);
+
+boolean loadReplayWindow(byte, long);
+
+long findReplayWindow(long);
+
+boolean replayCovers(byte, long);
+
+void getReplaySample(long, long *, long *, long *);
+
+uint32_t noiseRandom(void);
+
+long noiseGauss(long);
+
+boolean addSensorNoise(long *, long *, long *, long *);
+
+void setNoise(long *, long, long, const char *, const char *);
+
+unsigned long oxygenPumpTime(long, long);
+
+void startOxygenPump(const char *);
+
+long parseTenths(const char *);
+
+char *tenthsToChars(char *, long, byte);
+
+void resetBins(void);
+
+int binIndex(long);
+
+void addToBin(long, long, long);
+
+void setBinSetting(int *, long, const char *, const char *);
+
+void writeBytes(String);
+
+void writeBytes(const char *);
+
+void writeFlash(const char *, const long *, const char *const *);
+
+void queueBytes(const byte *, int);
+
+int txSpace(void);
+
+int txWrite(const byte *, int);
+
+void serviceTx(void);
+
+boolean validBaud(long);
+
+void startSerial1(void);
+
+void serviceBaud(void);
+
+unsigned long long missionClock(void);
+
+void pauseMissionClock(boolean);
+
+void setTimeScale(long);
+
+void startJob(int, unsigned long);
+
+void stopJob(int);
+
+void runJobs(void);
+
+void cpJob(void);
+
+void pistonJob(void);
+
+void phaseJob(void);
+
+void sernoJob(void);
+
+void replayJob(void);
+
+void storeJob(void);
+
+void oxygenJob(void);
+
+void profileStartJob(void);
+
+void replyJob(void);
+
+void replyLater(const char *, unsigned long, boolean);
+
+void startUpload(int);
+
+int nextUploadRecord(char *);
+
+void getRawSample(int, char *);
+
+void serviceUpload(void);
+
+long long updateTime(void);
+
+void setup(void);
+
+void loop(void);
+
+void fillRxBuffer(void);
+
+void serviceCommand(void);
+
+void sortCommands(void);
+
+int compareCommands(byte, byte);
+
+byte commandChar(byte, byte);
+
+void resetCommand(void);
+
+int matchCommandChar(char);
+
+boolean feedCommand(char);
+
+void dispatchCommand(int);
+
+void cmdPrompt(long, const char *);
+void cmdListParameters(long, const char *);
+void cmdListPhases(long, const char *);
+void cmdStartMission(long, const char *);
+void cmdManualStart(long, const char *);
+void cmdEndMission(long, const char *);
+void cmdPauseMission(long, const char *);
+void cmdResumeMission(long, const char *);
+void cmdParkDescentTime(long, const char *);
+void cmdPreludeTime(long, const char *);
+void cmdParkPressure(long, const char *);
+void cmdDownTime(long, const char *);
+void cmdDeepProfileDescentTime(long, const char *);
+void cmdDeepProfilePressure(long, const char *);
+void cmdAscentTimeOut(long, const char *);
+void cmdMissionTime(long, const char *);
+void cmdAscentRate(long, const char *);
+void cmdShow(long, const char *);
+void cmdDisplayStatus(long, const char *);
+void cmdDisplayCalibration(long, const char *);
+void cmdStartProfile(long, const char *);
+void cmdStopProfile(long, const char *);
+void cmdBinAverage(long, const char *);
+void cmdDumpAverages(long, const char *);
+void cmdDumpAveragesHex(long, const char *);
+void cmdDumpAveragesBinary(long, const char *);
+void cmdDumpData(long, const char *);
+void cmdDumpTrace(long, const char *);
+void cmdStats(long, const char *);
+void cmdStatsReset(long, const char *);
+void cmdReplay(long, const char *);
+void cmdReplayOn(long, const char *);
+void cmdReplayOff(long, const char *);
+void cmdStore(long, const char *);
+void cmdStoreSync(long, const char *);
+void cmdNoise(long, const char *);
+void cmdNoiseOff(long, const char *);
+void cmdNoiseSeed(long, const char *);
+void cmdNoiseP(long, const char *);
+void cmdNoiseT(long, const char *);
+void cmdNoiseS(long, const char *);
+void cmdNoiseO(long, const char *);
+void cmdNoiseSpike(long, const char *);
+void cmdNoiseDropout(long, const char *);
+void cmdOxygen(long, const char *);
+void cmdOxygenNf(long, const char *);
+void cmdOxygenNs(long, const char *);
+void cmdPowerDown(long, const char *);
+void cmdPumpFast(long, const char *);
+void cmdOutputDensity(long, const char *);
+void cmdTimingDelays(long, const char *);
+void cmdBuild(long, const char *);
+void cmdEcho(long, const char *);
+void cmdTopBinInterval(long, const char *);
+void cmdTopBinSize(long, const char *);
+void cmdTopBinMax(long, const char *);
+void cmdMiddleBinInterval(long, const char *);
+void cmdMiddleBinSize(long, const char *);
+void cmdMiddleBinMax(long, const char *);
+void cmdBottomBinInterval(long, const char *);
+void cmdBottomBinSize(long, const char *);
+void cmdOutputPTS(long, const char *);
+void cmdOutputP(long, const char *);
+void cmdConstantP(long, const char *);
+void cmdIceDetect(long, const char *);
+void cmdIceDetectAt(long, const char *);
+void cmdIceCap(long, const char *);
+void cmdIceCapAt(long, const char *);
+void cmdIceBreakup(long, const char *);
+void cmdIceDetectOff(long, const char *);
+void cmdIceCapOff(long, const char *);
+void cmdIceBreakupOff(long, const char *);
+void cmdBaud(long, const char *);
+void cmdSchedule(long, const char *);
+void cmdTimeScale(long, const char *);
+void cmdHelp(long, const char *);
+
+
+/*************************************************************************/
+/*                              command table                            */
+/*                              *************                            */
+/*                                                                       */
+/* Every command the simulator answers on Serial1, one row per command:  */
+/* the name as it is sent by the APFx (without the carriage return), how */
+/* the rest of the command is read (ARG_*), whether it is ignored during */
+/* continuous profiling (CMD_*), how many seconds the APFx has to send   */
+/* the value of a command that takes one (0: none is sent), and the      */
+/* handler that builds the reply.                                        */
+/* The table lives in flash. The rows can be in any order, setup() sorts */
+/* an index over them (commandOrder). A command that is complete on its  */
+/* name (anything but ARG_NONE) can't be the start of another command.   */
+/* To add a command, add a row and a handler.                            */
+/*                                                                       */
+/*************************************************************************/
+
+typedef void (*CommandHandler)(long, const char *);
+
+struct Command {
+  char name[CMDNAMELEN];
+  byte argType;
+  byte flags;
+  byte timeout;
+  CommandHandler handler;
+};
+
+const Command commands[] PROGMEM = {
+  {"",                       ARG_NONE,   CMD_NOTCP,   0,  cmdPrompt},
+#if HAS_MISSION
+  {"i*l",                    ARG_NONE,   CMD_ANYTIME, 0,  cmdListParameters},
+  {"i*s",                    ARG_NONE,   CMD_ANYTIME, 0,  cmdListPhases},
+  {"e",                      ARG_NONE,   CMD_ANYTIME, 0,  cmdStartMission},
+  {"start",                  ARG_NONE,   CMD_ANYTIME, 0,  cmdManualStart},
+  {"k",                      ARG_NONE,   CMD_ANYTIME, 0,  cmdEndMission},
+  {"pause mission",          ARG_NONE,   CMD_ANYTIME, 0,  cmdPauseMission},
+  {"resume mission",         ARG_NONE,   CMD_ANYTIME, 0,  cmdResumeMission},
+  {PARKDESCENTTIME,          ARG_NUMBER, CMD_ANYTIME, 30, cmdParkDescentTime},
+  {PARKDESCENTTIME2,         ARG_NUMBER, CMD_ANYTIME, 30, cmdParkDescentTime},
+  {PRELUDETIME,              ARG_NUMBER, CMD_ANYTIME, 30, cmdPreludeTime},
+  {PRELUDETIME2,             ARG_NUMBER, CMD_ANYTIME, 30, cmdPreludeTime},
+  {PARKPRESSURE,             ARG_NUMBER, CMD_ANYTIME, 30, cmdParkPressure},
+  {PARKPRESSURE2,            ARG_NUMBER, CMD_ANYTIME, 30, cmdParkPressure},
+  {DOWNTIME,                 ARG_NUMBER, CMD_ANYTIME, 30, cmdDownTime},
+  {DOWNTIME2,                ARG_NUMBER, CMD_ANYTIME, 30, cmdDownTime},
+  {DEEPPROFILEDESCENTTIME,   ARG_NUMBER, CMD_ANYTIME, 30, cmdDeepProfileDescentTime},
+  {DEEPPROFILEDESCENTTIME2,  ARG_NUMBER, CMD_ANYTIME, 30, cmdDeepProfileDescentTime},
+  {DEEPPROFILEPRESSURE,      ARG_NUMBER, CMD_ANYTIME, 30, cmdDeepProfilePressure},
+  {DEEPPROFILEPRESSURE2,     ARG_NUMBER, CMD_ANYTIME, 30, cmdDeepProfilePressure},
+  {ASCENTTIMEOUT,            ARG_NUMBER, CMD_ANYTIME, 30, cmdAscentTimeOut},
+  {ASCENTTIMEOUT2,           ARG_NUMBER, CMD_ANYTIME, 30, cmdAscentTimeOut},
+  {MISSIONTIME,              ARG_NUMBER, CMD_ANYTIME, 30, cmdMissionTime},
+  {"ascentRate=",            ARG_NUMBER, CMD_ANYTIME, 30, cmdAscentRate},
+  {"show ",                  ARG_NAME,   CMD_ANYTIME, 30, cmdShow},
+#endif
+  {"ds",                     ARG_NONE,   CMD_NOTCP,   0,  cmdDisplayStatus},
+  {"dc",                     ARG_NONE,   CMD_NOTCP,   0,  cmdDisplayCalibration},
+#if HAS_CP
+  {"startprofile",           ARG_NOW,    CMD_ANYTIME, 0,  cmdStartProfile},
+  {"stopprofile",            ARG_NONE,   CMD_ANYTIME, 0,  cmdStopProfile},
+  {"binaverage",             ARG_NONE,   CMD_NOTCP,   0,  cmdBinAverage},
+  {"da",                     ARG_NONE,   CMD_NOTCP,   0,  cmdDumpAverages},
+  {"dah",                    ARG_NONE,   CMD_NOTCP,   0,  cmdDumpAveragesHex},
+  {"dab",                    ARG_NONE,   CMD_NOTCP,   0,  cmdDumpAveragesBinary},
+  {"dd",                     ARG_NONE,   CMD_NOTCP,   0,  cmdDumpData},
+  {"qsr",                    ARG_NONE,   CMD_NOTCP,   0,  cmdPowerDown},
+  {"autobinavg=n",           ARG_NONE,   CMD_NOTCP,   0,  cmdEcho},
+  {"pcutoff=2.0",            ARG_NONE,   CMD_NOTCP,   0,  cmdEcho},
+  {"tswait=20",              ARG_NONE,   CMD_NOTCP,   0,  cmdEcho},
+  {"top_bin_interval=",      ARG_NUMBER, CMD_NOTCP,   30, cmdTopBinInterval},
+  {"top_bin_size=",          ARG_NUMBER, CMD_NOTCP,   30, cmdTopBinSize},
+  {"top_bin_max=",           ARG_NUMBER, CMD_NOTCP,   30, cmdTopBinMax},
+  {"middle_bin_interval=",   ARG_NUMBER, CMD_NOTCP,   30, cmdMiddleBinInterval},
+  {"middle_bin_size=",       ARG_NUMBER, CMD_NOTCP,   30, cmdMiddleBinSize},
+  {"middle_bin_max=",        ARG_NUMBER, CMD_NOTCP,   30, cmdMiddleBinMax},
+  {"bottom_bin_interval=",   ARG_NUMBER, CMD_NOTCP,   30, cmdBottomBinInterval},
+  {"bottom_bin_size=",       ARG_NUMBER, CMD_NOTCP,   30, cmdBottomBinSize},
+  {"includetransitionbin=n", ARG_NONE,   CMD_NOTCP,   0,  cmdEcho},
+  {"includenbin=y",          ARG_NONE,   CMD_NOTCP,   0,  cmdEcho},
+  {"outputpts=y",            ARG_NONE,   CMD_NOTCP,   0,  cmdOutputPTS},
+  {"outputpts=n",            ARG_NONE,   CMD_NOTCP,   0,  cmdOutputP},
+#else
+  {"qs",                     ARG_NONE,   CMD_NOTCP,   0,  cmdPowerDown},
+  {"pumpfastpt=y",           ARG_NONE,   CMD_NOTCP,   0,  cmdPumpFast},
+  {"pumpfastpt=n",           ARG_NONE,   CMD_NOTCP,   0,  cmdPumpFast},
+  {"outputdensity=y",        ARG_NONE,   CMD_NOTCP,   0,  cmdOutputDensity},
+  {"outputdensity=n",        ARG_NONE,   CMD_NOTCP,   0,  cmdOutputDensity},
+  {"addtimingdelays=y",      ARG_NONE,   CMD_NOTCP,   0,  cmdTimingDelays},
+  {"addtimingdelays=n",      ARG_NONE,   CMD_NOTCP,   0,  cmdTimingDelays},
+  {"dsreplyformat=s",        ARG_NONE,   CMD_NOTCP,   0,  cmdEcho},
+#if HAS_OXYGEN
+  {"oxnf=",                  ARG_NUMBER, CMD_NOTCP,   30, cmdOxygenNf},
+  {"oxns=",                  ARG_NUMBER, CMD_NOTCP,   30, cmdOxygenNs},
+  {"oxygen",                 ARG_NONE,   CMD_ANYTIME, 0,  cmdOxygen},
+#else
+  {"oxnf=2.0",               ARG_NONE,   CMD_NOTCP,   0,  cmdEcho},
+  {"oxns=0.0",               ARG_NONE,   CMD_NOTCP,   0,  cmdEcho},
+#endif
+#endif
+#if HAS_BUILD
+  {"build",                  ARG_NONE,   CMD_NOTCP,   0,  cmdBuild},
+#endif
+  {"constantP=",             ARG_NUMBER, CMD_ANYTIME, 30, cmdConstantP},
+  {"id",                     ARG_NONE,   CMD_ANYTIME, 0,  cmdIceDetect},
+  {"id on",                  ARG_NONE,   CMD_ANYTIME, 0,  cmdIceDetect},
+  {"id@",                    ARG_NUMBER, CMD_ANYTIME, 30, cmdIceDetectAt},
+  {"id off",                 ARG_NONE,   CMD_ANYTIME, 0,  cmdIceDetectOff},
+  {"ic",                     ARG_NONE,   CMD_ANYTIME, 0,  cmdIceCap},
+  {"ic on",                  ARG_NONE,   CMD_ANYTIME, 0,  cmdIceCap},
+  {"ic@",                    ARG_NUMBER, CMD_ANYTIME, 30, cmdIceCapAt},
+  {"ic off",                 ARG_NONE,   CMD_ANYTIME, 0,  cmdIceCapOff},
+  {"ib",                     ARG_NONE,   CMD_ANYTIME, 0,  cmdIceBreakup},
+  {"ib on",                  ARG_NONE,   CMD_ANYTIME, 0,  cmdIceBreakup},
+  {"ib off",                 ARG_NONE,   CMD_ANYTIME, 0,  cmdIceBreakupOff},
+  {"baud=",                  ARG_NUMBER, CMD_NOTCP,   30, cmdBaud},
+  {"sched",                  ARG_NONE,   CMD_ANYTIME, 0,  cmdSchedule},
+  {"dumptrace",              ARG_NONE,   CMD_NOTCP,   0,  cmdDumpTrace},
+  {"stats",                  ARG_NONE,   CMD_ANYTIME, 0,  cmdStats},
+  {"stats reset",            ARG_NONE,   CMD_ANYTIME, 0,  cmdStatsReset},
+  {"replay",                 ARG_NONE,   CMD_ANYTIME, 0,  cmdReplay},
+  {"replay on",              ARG_NONE,   CMD_ANYTIME, 0,  cmdReplayOn},
+  {"replay off",             ARG_NONE,   CMD_ANYTIME, 0,  cmdReplayOff},
+  {"store",                  ARG_NONE,   CMD_ANYTIME, 0,  cmdStore},
+  {"store sync",             ARG_NONE,   CMD_ANYTIME, 0,  cmdStoreSync},
+  {"noise",                  ARG_NONE,   CMD_ANYTIME, 0,  cmdNoise},
+  {"noise off",              ARG_NONE,   CMD_ANYTIME, 0,  cmdNoiseOff},
+  {"noise seed=",            ARG_NUMBER, CMD_ANYTIME, 30, cmdNoiseSeed},
+  {"noise p=",               ARG_NUMBER, CMD_ANYTIME, 30, cmdNoiseP},
+  {"noise t=",               ARG_NUMBER, CMD_ANYTIME, 30, cmdNoiseT},
+  {"noise s=",               ARG_NUMBER, CMD_ANYTIME, 30, cmdNoiseS},
+  {"noise o=",               ARG_NUMBER, CMD_ANYTIME, 30, cmdNoiseO},
+  {"noise spike=",           ARG_NUMBER, CMD_ANYTIME, 30, cmdNoiseSpike},
+  {"noise dropout=",         ARG_NUMBER, CMD_ANYTIME, 30, cmdNoiseDropout},
+  {"timescale=",             ARG_NUMBER, CMD_ANYTIME, 30, cmdTimeScale},
+  {"?",                      ARG_NONE,   CMD_ANYTIME, 0,  cmdHelp},
+};
+
+#define NCOMMANDS int(sizeof(commands)/sizeof(commands[0]))
+
+//the rows of the command table sorted by name, filled by sortCommands
+byte commandOrder[NCOMMANDS];
+
+
+/*************************************************************************/
+/*                             flash replies                             */
+/*                             *************                             */
+/*                                                                       */
+/* The long replies that are the same every time but for a few values    */
+/* (i*l, ds, dc and ?), kept in flash and sent from there by writeFlash, */
+/* so they are never built in SRAM. FIELDNUMBER and FIELDTEXT mark where */
+/* writeFlash puts the next of the numbers and texts it is handed, in    */
+/* order.                                                                */
+/*                                                                       */
+/*************************************************************************/
+
+#define FIELDNUMBER "\x01"
+#define FIELDTEXT "\x02"
+
+//i*l: the mission parameters
+const char listText[] PROGMEM =
+  "\r\n" FIELDNUMBER " Prelude (minutes): Mtp<val>"
+  "\r\n" FIELDNUMBER " Park Pressure (dbar): Mk<val>"
+  "\r\n" FIELDNUMBER " Park Descent Time (minutes): Mtk<val>"
+  "\r\n" FIELDNUMBER " Down Time(minutes): Mtd<val>"
+  "\r\n" FIELDNUMBER " Deep Profile Pressure: Mj<val>"
+  "\r\n" FIELDNUMBER " Deep Profile Descent Time(minutes): Mtj<val>"
+  "\r\n" FIELDNUMBER " Ascent Time Out(minutes): Mta<val>"
+  "\r\n" FIELDNUMBER " Mission Time(seconds): i*t<val>"
+  "\r\nS>";
+
+//ds: the number of samples and bins and the bin settings, then the real-time output (SBE41cp);
+//the pump, timing delays and output density settings (SBE41 STD)
+const char dsText[] PROGMEM =
+#if HAS_CP
+  "ds\r\n" CTDMODEL "  SERIAL NO. 4242"
+  CTDFIRMWARE
+  "\r\nstop profile when pressure is less than = 2.0 decibars"
+  "\r\nautomatic bin averaging at end of profile disabled"
+  "\r\nnumber of samples = " FIELDNUMBER
+  "\r\nnumber of bins = " FIELDNUMBER
+  "\r\ntop bin interval = " FIELDNUMBER
+  "\r\ntop bin size = " FIELDNUMBER
+  "\r\ntop bin max = " FIELDNUMBER
+  "\r\nmiddle bin interval = " FIELDNUMBER
+  "\r\nmiddle bin size = " FIELDNUMBER
+  "\r\nmiddle bin max = " FIELDNUMBER
+  "\r\nbottom bin interval = " FIELDNUMBER
+  "\r\nbottom bin size = " FIELDNUMBER
+  "\r\ndo not include two transitions bins"
+  "\r\ninclude samples per bin"
+  "\r\npumped take sample wait time = 20 sec"
+  "\r\nreal-time output is " FIELDTEXT "\r\nS>";
+#else
+  "ds\r\n" CTDMODEL "  SERIAL NO. 4242"
+  "\r\n" FIELDTEXT " before faspt measurement"
+  CTDFIRMWARE
+  "\r\nadd timing delays = " FIELDTEXT
+  "\r\noutput density = " FIELDTEXT "\r\nS>";
+#endif
+
+//dc: the calibration coefficients, generic ones from an actual seabird
+const char dcText[] PROGMEM = "dc\r\n" CTDMODEL "  SERIAL NO. 4242"
+  "\r\ntemperature:  19-dec-10"
+  "\r\n    TA0 =  4.882851e-05"
+  "\r\n    TA1 =  2.747638e-04"
+  "\r\n    TA2 = -2.478284e-06"
+  "\r\n    TA3 =  1.530870e-07"
+  "\r\nconductivity:  19-dec-10"
+  "\r\n    G = -1.013506e+00"
+  "\r\n    H =  1.473695e-01"
+  "\r\n    I = -3.584262e-04"
+  "\r\n    J =  4.733101e-05"
+  "\r\n    CPCOR = -9.570001e-08"
+  "\r\n    CTCOR =  3.250000e-06"
+  "\r\n    WBOTC =  2.536509e-08"
+  "\r\npressure S/N = 3212552, range = 2900 psia:  14-dec-10    "
+  "\r\nPA0 =  6.297445e-01"
+  "\r\n    PA1 =  1.403743e-01"
+  "\r\n    PA2 = -3.996384e-08"
+  "\r\n    PTCA0 =  6.392568e+01"
+  "\r\n    PTCA1 =  2.642689e-01"
+  "\r\n    PTCA2 = -2.513274e-03"
+  "\r\n    PTCB0 =  2.523900e+01"
+  "\r\n    PTCB1 = -2.000000e-04"
+  "\r\n    PTCB2 =  0.000000e+00"
+  "\r\n    PTHA0 = -7.752968e+01"
+  "\r\n    PTHA1 =  5.141199e-02"
+  "\r\n    PTHA2 = -7.570264e-07"
+  "\r\n    POFFSET =  0.000000e+00"
+#if HAS_OXYGEN
+  "\r\noxygen S/N = 1234, 19-dec-10"
+  "\r\n    TAU_20 = " FIELDTEXT
+  "\r\n    Ns = " FIELDTEXT
+  "\r\n    Nf = " FIELDTEXT
+#endif
+  "\r\nS>";
+
+//?: the simulation type and the commands
+const char helpText[] PROGMEM = "?\r\n" SIMNAME
+  "\r\nid"
+  "\r\nid@<value>"
+  "\r\nid off"
+  "\r\nic"
+  "\r\nic@<value>"
+  "\r\nic off"
+  "\r\nib"
+  "\r\nib off"
+#if HAS_CP
+  "\r\nqsr"
+  "\r\nda"
+  "\r\ndah"
+  "\r\ndab"
+#else
+  "\r\nqs"
+  "\r\npumpfastpt=<y/n>"
+  "\r\noutputdensity=<y/n>"
+  "\r\naddtimingdelays=<y/n>"
+#endif
+#if HAS_OXYGEN
+  "\r\noxnf=<value>"
+  "\r\noxns=<value>"
+  "\r\noxygen"
+#endif
+#if HAS_BUILD
+  "\r\nbuild"
+#endif
+  "\r\nds"
+  "\r\ndc"
+  "\r\nbaud=<value>"
+  "\r\nsched"
+  "\r\ndumptrace"
+  "\r\nstats"
+  "\r\nstats reset"
+  "\r\nreplay"
+  "\r\nreplay on"
+  "\r\nreplay off"
+  "\r\nstore"
+  "\r\nstore sync"
+  "\r\nnoise"
+  "\r\nnoise off"
+  "\r\nnoise seed=<value>"
+  "\r\nnoise p=<value>"
+  "\r\nnoise t=<value>"
+  "\r\nnoise s=<value>"
+  "\r\nnoise o=<value>"
+  "\r\nnoise spike=<value>"
+  "\r\nnoise dropout=<value>"
+  "\r\ntimescale=<value>\r\nS>";
+
+
+/*************************************************************************/
+/*                              water column                             */
+/*                              ************                             */
+/*                                                                       */
+/* The temperature and salinity (ten thousandths of a degree C and PSU)  */
+/* of the water every 50 dbar from the surface to 2000 dbar, the first   */
+/* row is the surface. getWaterSample interpolates between the rows, so  */
+/* a more realistic profile only needs new rows here. These follow the   */
+/* generic model tested by Hugh Fargher, temperature = 23.2 - 0.0088*p   */
+/* and salinity = temperature*0.1 + 34.9.                                */
+/*                                                                       */
+/*************************************************************************/
+
+struct WaterLevel {
+  long temperature;
+  long salinity;
+};
+
+const WaterLevel waterColumn[] PROGMEM = {
+  { 232000,  372200},   //    0 dbar
+  { 227600,  371760},   //   50 dbar
+  { 223200,  371320},   //  100 dbar
+  { 218800,  370880},   //  150 dbar
+  { 214400,  370440},   //  200 dbar
+  { 210000,  370000},   //  250 dbar
+  { 205600,  369560},   //  300 dbar
+  { 201200,  369120},   //  350 dbar
+  { 196800,  368680},   //  400 dbar
+  { 192400,  368240},   //  450 dbar
+  { 188000,  367800},   //  500 dbar
+  { 183600,  367360},   //  550 dbar
+  { 179200,  366920},   //  600 dbar
+  { 174800,  366480},   //  650 dbar
+  { 170400,  366040},   //  700 dbar
+  { 166000,  365600},   //  750 dbar
+  { 161600,  365160},   //  800 dbar
+  { 157200,  364720},   //  850 dbar
+  { 152800,  364280},   //  900 dbar
+  { 148400,  363840},   //  950 dbar
+  { 144000,  363400},   // 1000 dbar
+  { 139600,  362960},   // 1050 dbar
+  { 135200,  362520},   // 1100 dbar
+  { 130800,  362080},   // 1150 dbar
+  { 126400,  361640},   // 1200 dbar
+  { 122000,  361200},   // 1250 dbar
+  { 117600,  360760},   // 1300 dbar
+  { 113200,  360320},   // 1350 dbar
+  { 108800,  359880},   // 1400 dbar
+  { 104400,  359440},   // 1450 dbar
+  { 100000,  359000},   // 1500 dbar
+  {  95600,  358560},   // 1550 dbar
+  {  91200,  358120},   // 1600 dbar
+  {  86800,  357680},   // 1650 dbar
+  {  82400,  357240},   // 1700 dbar
+  {  78000,  356800},   // 1750 dbar
+  {  73600,  356360},   // 1800 dbar
+  {  69200,  355920},   // 1850 dbar
+  {  64800,  355480},   // 1900 dbar
+  {  60400,  355040},   // 1950 dbar
+  {  56000,  354600},   // 2000 dbar
+};
+
+#define NWATERLEVELS int(sizeof(waterColumn)/sizeof(waterColumn[0]))
+
+//the frequency (Hz) of the SBE43F at the same rows, high in the mixed layer and lowest in an
+//oxygen minimum around 800 dbar
+const unsigned int oxygenColumn[NWATERLEVELS] PROGMEM = {
+  4490,   //    0 dbar
+  4210,   //   50 dbar
+  4000,   //  100 dbar
+  3820,   //  150 dbar
+  3670,   //  200 dbar
+  3540,   //  250 dbar
+  3420,   //  300 dbar
+  3310,   //  350 dbar
+  3200,   //  400 dbar
+  3100,   //  450 dbar
+  3000,   //  500 dbar
+  2900,   //  550 dbar
+  2810,   //  600 dbar
+  2740,   //  650 dbar
+  2680,   //  700 dbar
+  2640,   //  750 dbar
+  2620,   //  800 dbar
+  2630,   //  850 dbar
+  2660,   //  900 dbar
+  2700,   //  950 dbar
+  2760,   // 1000 dbar
+  2830,   // 1050 dbar
+  2910,   // 1100 dbar
+  2980,   // 1150 dbar
+  3050,   // 1200 dbar
+  3100,   // 1250 dbar
+  3160,   // 1300 dbar
+  3200,   // 1350 dbar
+  3230,   // 1400 dbar
+  3250,   // 1450 dbar
+  3270,   // 1500 dbar
+  3280,   // 1550 dbar
+  3290,   // 1600 dbar
+  3290,   // 1650 dbar
+  3300,   // 1700 dbar
+  3300,   // 1750 dbar
+  3300,   // 1800 dbar
+  3300,   // 1850 dbar
+  3300,   // 1900 dbar
+  3300,   // 1950 dbar
+  3300,   // 2000 dbar
+};
+
+
+/*************************************************************************/
+/*                               scheduler                               */
+/*                               *********                               */
+/*                                                                       */
+/* The jobs the loop runs on time, one row per job (in the order of the  */
+/* JOB_ #defines). A job with a period runs once every period (ms) from  */
+/* when it was started, a job with a period of 0 runs once. next is when */
+/* the job is due, it is moved on by whole periods from the time it was  */
+/* started so a late run doesn't push the later ones back. runs, overruns*/
+/* and lateMax count how many times it ran, how many runs were missed    */
+/* because the loop was busy for more than a period, and the latest (ms) */
+/* it has run, the sched command lists them.                             */
+/*                                                                       */
+/*************************************************************************/
+
+struct Job {
+  const char *name;
+  unsigned long period;
+  void (*run)(void);
+  boolean active;
+  unsigned long next;
+  unsigned int runs;
+  unsigned int overruns;
+  unsigned long lateMax;
+};
+
+Job jobs[] = {
+  {"piston",       15000, pistonJob,       false, 0, 0, 0, 0},
+  {"phase",        1000,  phaseJob,        false, 0, 0, 0, 0},
+  {"serno",        0,     sernoJob,        false, 0, 0, 0, 0},
+  {"replay",       0,     replayJob,       false, 0, 0, 0, 0},
+  {"store",        STOREPERIOD, storeJob,  false, 0, 0, 0, 0},
+  {"oxygen",       0,     oxygenJob,       false, 0, 0, 0, 0},
+  {"reply",        0,     replyJob,        false, 0, 0, 0, 0},
+#if HAS_CP
+  {"cp",           1000,  cpJob,           false, 0, 0, 0, 0},
+  {"profilestart", 0,     profileStartJob, false, 0, 0, 0, 0},
+#endif
+};
+
+#define NJOBS int(sizeof(jobs)/sizeof(jobs[0]))
+
+
+/*************************************************************************/
+/*                              checkline                                */
+/*                              *********                                */
+/*                                                                       */
+/* Attached to a rising logic level on pin 2                             */
+/*                                                                       */
+/* paramaters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Starts decoding a request over the hardware lines. Nothing is read    */
+/* here, Timer1 is started and lineTick samples the lines on its ticks,  */
+/* so the interrupt returns right away. The time of the edge is kept for */
+/* the latency of the request (stats). A rising edge while a request is  */
+/* being decoded is ignored.                                             */
+/*                                                                       */
+/*************************************************************************/
+
+
+void checkLine(void){
+  if(lineTicks < 0){
+    lineRise = clockMicros();
+    lineTicks = 0;
+    rxVotes = 0;
+    modeVotes = 0;
+    lineTimerStart();
+  }
+}
+
+
+
+/*************************************************************************/
+/*                               lineTick                                */
+/*                               ********                                */
+/*                                                                       */
+/* Attached to Timer1, runs every LINETICK us (~50ms) while a request is */
+/* being decoded                                                         */
+/*                                                                       */
+/* paramaters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* ~200ms after the request line rises, check it. If still high, send    */
+/* the APF9 the fw rev and turn command mode on. If the request line is  */
+/* low and the mode line is high, send the APF9 a P,T,S sample.          */
+/* Otherwise the Rx and mode lines are sampled on this tick and the next */
+/* 5 (once / ~50ms), a line is high if at least 2 of the 6 samples are.  */
+/* If the mode line is low, send a P,T sample if the Rx line is high or  */
+/* a P sample if it is low. The request is posted to loop() in           */
+/* interruptMessage, the samples are determined by getReadingFromPiston  */
+/* and getDynamicReading and sent from there.                            */
+/*                                                                       */
+/*           ***************************************************         */
+/*           **  Request  *    Rx    *   Mode   *   Message   **         */
+/*           ***************************************************         */
+/*           **   HIGH    *   ----   *   ----   *   Serial #  **         */
+/*           ***************************************************         */
+/*           **    LOW    *   ----   *   HIGH   *    P,T,S    **         */
+/*           ***************************************************         */
+/*           **    LOW    *   HIGH   *    LOW   *     P,T     **         */
+/*           ***************************************************         */
+/*           **    LOW    *    LOW   *    LOW   *      P      **         */
+/*           ***************************************************         */
+/*                                                                       */
+/*************************************************************************/
+
+
+void lineTick(void){
+  if(lineTicks < 0){
+    return;
+  }
+  lineTicks++;
+  
+  //wait ~200ms after the request line rose
+  if(lineTicks < LINEWAIT){
+    return;
+  }
+  
+  if(lineTicks == LINEWAIT){
+    
+    //if the request line is still high, choose message 1 (get serial number / firmware rev) 
+    if(readLine(2)==HIGH){
+      interruptMessage = SERNO;
+      lineTicks = -1;
+      lineTimerStop();
+      return;
+    }
+    
+    //if the request line is low and the mode line is high, choose message 2 (get pts)
+    if(readLine(3)==HIGH){
+      interruptMessage = PTS;
+      lineTicks = -1;
+      lineTimerStop();
+      return;
+    }
+  }
+  
+  //sample the Rx line (19) and the mode line (3) to be safe
+  if(readLine(19)==HIGH){
+    rxVotes++;
+  }
+  if(readLine(3)==HIGH){
+    modeVotes++;
+  }
+  
+  if(lineTicks == LINEWAIT + LINEVOTES - 1){
+    
+    //if the mode line is low, choose message 3 (get pt) if the Rx line is high
+    //or message 4 (get p) if the Rx line is low
+    if(modeVotes < LINEHIGH){
+      if(rxVotes >= LINEHIGH){
+        interruptMessage = PT;
+      }
+      else{
+        interruptMessage = P;
+      }
+    }
+    lineTicks = -1;
+    lineTimerStop();
+  }
+}
+
+/*************************************************************************/
+/*                                 setup                                 */
+/*                                 *****                                 */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Part of programming in Arduino, used to set up the board for the      */
+/* program. Enables serial communication over ports 1 and 2, at a baud   */
+/* rate of 9600 for both (or the rate kept in the EEPROM for port 1).    */
+/* It also configures pins 8 as an ouput.                                */
+/* It configures pins 2, 3, and A0 as inputs. Pin 2 and 3 are digital    */
+/* inputs. A0 is an analog input. It sets the reference voltage for      */
+/* analog input at 2.56V as its max. It attaches an interrupt to pin 2   */
+/* that will run the function checkLines if it is triggered by a rising  */
+/* edge. It also initializes the timer with a period of LINETICK us that */
+/* runs lineTick, stopped until a request comes in, sorts the command    */
+/* table, builds the ice overlay of the water column, opens the recorded */
+/* profile if there is one and the files it records to on the SD card,   */
+/* and starts the piston and phase jobs of the scheduler.                */
+/*                                                                       */
+/*************************************************************************/
+
+void setup(void){
+  //initialize serial ports at 9600 baud 8-N-1 (or Serial1 at the rate it was set to)
+  Serial.begin(9600);
+  startSerial1();
+  
+  //sets pins 2 (digital), 3 (digital), and A0 (analog) as inputs, pin 8 as an output,
+  //and the analog reference (max) voltage at 2.56V
+  halSetup();
+  
+  //if there is a rising edge on pin 2, the function checkLine will be called
+  requestAttach(checkLine);
+  
+  //initializes the timer with a period of ~50ms to decode the hardware lines, it only
+  //runs while checkLine has a request to decode
+  lineTimerInit(LINETICK, lineTick);
+  
+  //sort the command table so commands can be matched as they arrive
+  sortCommands();
+  
+  //work out the ascent of the default mission, its schedule is built with the water column
+  setAscentTimes();
+  
+  //start with the water column of the default ice avoidance mode
+  buildIceOverlay();
+  buildMissionSchedule();
+  
+  //the samples come from the recorded profile if there is one
+  replayOn = startReplay();
+  
+  //the continuous profile samples and the trace are recorded to the SD card if there is one
+  startStores();
+  
+  //the piston is checked and the phase of a mission is kept up from now on
+  startJob(JOB_PISTON, 15000);
+  startJob(JOB_PHASE, 1000);
+}
+
+/*************************************************************************/
+/*                                 loop                                  */
+/*                                 ****                                  */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Part of programming in Arduino, used as the main loop. It performs a  */
+/* digitalWrite to pin 8 which is connected to an LED to let the tester  */
+/* know that the device is on and ready. It runs the jobs of the         */
+/* scheduler that are due. The loop then enters a switch                 */
+/* statement to handle the sending of messages based on the value of     */
+/* interruptMessage which is changed by the itnerrupt on pin 2. The rest */
+/* of the function handles receiving and sending correct serial messages */
+/* over the Serial1 Tx and Rx lines. It does so by sending response      */
+/* strings as arrays of bytes. Nothing in the loop waits for the APFx,   */
+/* commands are put together from whatever characters have arrived.     */
+/*                                                                       */
+/*************************************************************************/
+
+
+void loop(void){
+  
+  //the reply to a request over the hardware lines
+  char reply[REPLYSIZE];
+  
+  //the reading a PTS request is answered with, PTSO once the oxygen sensor is set up
+  int select;
+  
+  writeLed(HIGH);
+  
+  //hand Serial1 whatever is waiting to be sent that fits in its transmit buffer
+  serviceTx();
+  
+  //change the baud rate once the reply to baud= is sent, or go back to 9600 if the 
+  //new rate isn't confirmed in time
+  serviceBaud();
+  
+  //run the jobs that are due (continuous profiling samples, piston checks, phase updates
+  //and the replies that wait before they are sent)
+  runJobs();
+    
+  //interruptMessage will be zero unless changed during the ISR, this section of code
+  //will handle if there is an interrupt
+  
+  //send the next part of a bulk upload (dd, da, dah), requests over the hardware lines 
+  //and commands wait until it is done, and until the reply job has sent the echo of the
+  //last command
+  if(uploadType != UPLOAD_NONE){
+    serviceUpload();
+  }
+  
+  //if interrupt message has not changed (or a request is waiting for an upload or a reply)
+  switch(((uploadType == UPLOAD_NONE)&&!jobs[JOB_REPLY].active) ? interruptMessage : 0){
+    //if interrupt message is 1, send the serial number over Serial1 ~1.24 sec from now
+    //(sernoJob), ignore the hardware lines until a command turns them back on, reset
+    //interruptMessage to 0
+    case SERNO:
+      if(cpMode == -1){
+        trace(TRACE_LINE, SERNO);
+        startStats(STATSLINE + SERNO, lineRise);
+        startJob(JOB_SERNO, 1240);
+        requestDetach();
+        interruptMessage = 0;
+      }
+      break;
+    
+    //if it is 2, clear any junk analog values on A0 before getting the p,t,s value based on the analog 
+    //value on pin A0 (or the mission), build the reading in the reply buffer, then send it over 
+    //Serial1 (with oxygen, after the pump, from the oxygen job), reset interruptMessage to 0. A 
+    //request while the pump runs is ignored
+    case PTS:
+      trace(TRACE_LINE, PTS);
+      if(jobs[JOB_OXYGEN].active){
+        interruptMessage = 0;
+        break;
+      }
+      startStats(STATSLINE + PTS, lineRise);
+      select = (HAS_OXYGEN && (oxygenNf > 0)) ? PTSO : PTS;
+      readPiston();
+      if(missionMode < 100){
+        getReadingFromPiston(select, reply);
+      }
+      else if(HAS_MISSION && (missionMode >= 100)){
+        getDynamicReading(select, reply);
+      }
+      if(select == PTSO){
+        startOxygenPump(reply);
+      }
+      else if(reply[0] != '\0'){
+        writeBytes(reply);
+      }
+      interruptMessage = 0;
+      break;
+  
+    //if it is 3, clear any junk analog values on A0 before getting the p,t value based on the analog
+    //value on pin A0 (or the mission), build the reading in the reply buffer, then send it over 
+    //Serial1, reset interruptMessage to 0
+    case PT:
+      trace(TRACE_LINE, PT);
+      startStats(STATSLINE + PT, lineRise);
+      readPiston();
+      if(missionMode < 100){
+        getReadingFromPiston(PT, reply);
+      }
+      else if(HAS_MISSION && (missionMode >= 100)){
+        getDynamicReading(PT, reply);
+      }
+      if(reply[0] != '\0'){
+        writeBytes(reply);
+      }
+      interruptMessage = 0;
+      break;
+
+    //if it is 4, clear any junk analog values on A0 before getting the p value based on the analog
+    //value on pin A0 (or the mission), build the reading in the reply buffer, then send it over 
+    //Serial1, reset interruptMessage to 0
+    case P:
+      trace(TRACE_LINE, P);
+      startStats(STATSLINE + P, lineRise);
+      readPiston();
+      if(missionMode < 100){
+        getReadingFromPiston(P, reply);
+      }
+      else if(HAS_MISSION && (missionMode >= 100)){
+        getDynamicReading(P, reply);
+      }
+      if(reply[0] != '\0'){
+        writeBytes(reply);
+      }
+      interruptMessage = 0;
+      break;
+  }
+  
+
+  //feed the characters received on Serial1 to the command table, a command is handled once it
+  //is complete, a partial one is kept until the next time through the loop
+  if((uploadType == UPLOAD_NONE)&&!jobs[JOB_REPLY].active){
+    serviceCommand();
+  }
+}
+
+
+
+/*************************************************************************/
+/*                              fillRxBuffer                             */
+/*                              ************                             */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function moves the characters waiting in the Serial1 input       */
+/* buffer into rxBuffer. If rxBuffer is full, the rest are left in the   */
+/* Serial1 buffer until there is room.                                   */
+/*                                                                       */
+/*************************************************************************/
+
+void fillRxBuffer(void){
+  byte next;
+  while(ctdAvailable()>0){
+    next = (rxHead + 1) % RXBUFFERSIZE;
+    if(next == rxTail){
+      break;
+    }
+    rxBuffer[rxHead] = char(ctdRead());
+    rxHead = next;
+  }
+}
+
+
+
+/*************************************************************************/
+/*                             serviceCommand                            */
+/*                             **************                            */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Called every time through the loop. This function feeds the received  */
+/* characters to the command table (feedCommand) until a command is      */
+/* complete or rxBuffer is empty, it never waits for more characters, so */
+/* a command typed slowly is put together over many passes through the   */
+/* loop. At most one command is handled per pass, the rest wait in       */
+/* rxBuffer. A partial command is thrown away if the APFx goes quiet:    */
+/* RXTIMEOUT ms between the characters of the name, or the timeout of    */
+/* the command (seconds) once the name of a command that takes a value   */
+/* has matched.                                                          */
+/*                                                                       */
+/*************************************************************************/
+
+void serviceCommand(void){
+  unsigned long timeout;
+  char c;
+  
+  fillRxBuffer();
+  while(rxTail != rxHead){
+    c = rxBuffer[rxTail];
+    rxTail = (rxTail + 1) % RXBUFFERSIZE;
+    rxLast = clockMillis();
+    if(feedCommand(c)){
+      return;
+    }
+  }
+  
+  //nothing received yet
+  if((cmdLen == 0)&&(cmdMatch < 0)){
+    return;
+  }
+  
+  //time out a partial command
+  timeout = RXTIMEOUT;
+  if((cmdMatch >= 0)&&(pgm_read_byte(&commands[cmdMatch].argType) != ARG_NONE)){
+    timeout = 1000UL*pgm_read_byte(&commands[cmdMatch].timeout);
+  }
+  if((clockMillis() - rxLast) > timeout){
+    resetCommand();
+  }
+}
+
+
+
+/*************************************************************************/
+/*                              sortCommands                             */
+/*                              ************                             */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function fills commandOrder with the indices of the rows of the  */
+/* command table sorted by name. Sorted names form a trie laid out flat: */
+/* all of the commands that start with the characters received so far   */
+/* are next to each other, so matchCommandChar only has to narrow a      */
+/* range. Called once from setup, so the rows of the table can stay in   */
+/* whatever order is easiest to read.                                    */
+/*                                                                       */
+/*************************************************************************/
+
+void sortCommands(void){
+  int i, j;
+  byte index;
+  
+  //insertion sort, the table is small and this only runs once
+  for(i = 0; i < NCOMMANDS; i++){
+    index = i;
+    for(j = i; (j > 0)&&(compareCommands(commandOrder[j-1], index) > 0); j--){
+      commandOrder[j] = commandOrder[j-1];
+    }
+    commandOrder[j] = index;
+  }
+  resetCommand();
+}
+
+
+
+/*************************************************************************/
+/*                             compareCommands                           */
+/*                             ***************                           */
+/*                                                                       */
+/* parameters: a, b, the rows of the command table to compare            */
+/*                                                                       */
+/* returns: an int that is negative, zero or positive if the name of a   */
+/*                 sorts before, the same as, or after the name of b     */
+/*                                                                       */
+/*************************************************************************/
+
+int compareCommands(byte a, byte b){
+  byte pos;
+  for(pos = 0; pos < CMDNAMELEN; pos++){
+    if(commandChar(a, pos) != commandChar(b, pos)){
+      return int(commandChar(a, pos)) - int(commandChar(b, pos));
+    }
+    if(commandChar(a, pos) == 0){
+      break;
+    }
+  }
+  return 0;
+}
+
+
+
+/*************************************************************************/
+/*                              commandChar                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: index, the row of the command table                       */
+/*             pos, the position of the character in the command name    */
+/*                                                                       */
+/* returns: the character of the name at pos, 0 past the end of the name */
+/*                                                                       */
+/*************************************************************************/
+
+byte commandChar(byte index, byte pos){
+  if(pos >= CMDNAMELEN){
+    return 0;
+  }
+  return pgm_read_byte(&commands[index].name[pos]);
+}
+
+
+
+/*************************************************************************/
+/*                              resetCommand                             */
+/*                              ************                             */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function throws away a partially received command and gets       */
+/* ready to match the next one against the whole command table.          */
+/*                                                                       */
+/*************************************************************************/
+
+void resetCommand(void){
+  cmdLo = 0;
+  cmdHi = NCOMMANDS;
+  cmdLen = 0;
+  cmdMatch = -1;
+  argLen = 0;
+  argBuff[0] = '\0';
+}
+
+
+
+/*************************************************************************/
+/*                            matchCommandChar                           */
+/*                            ****************                           */
+/*                                                                       */
+/* parameters: c, the next character received                            */
+/*                                                                       */
+/* returns: an int that is the row of the command table whose name is    */
+/*                 exactly the characters received so far, or -1         */
+/*                                                                       */
+/* This function narrows the range [cmdLo, cmdHi) of commandOrder to the */
+/* commands whose names start with the characters received so far. Both  */
+/* ends of the range are found with a binary search on the character at  */
+/* the current position, so each character costs a handful of compares  */
+/* no matter how many commands there are or where a command sits in the  */
+/* table. Once the range is empty nothing can match anymore.             */
+/*                                                                       */
+/*************************************************************************/
+
+int matchCommandChar(char c){
+  byte ch = byte(c);
+  byte lo = cmdLo;
+  byte hi = cmdHi;
+  byte mid;
+  
+  //first command in the range whose character at this position is >= c
+  while(lo < hi){
+    mid = (lo + hi)/2;
+    if(commandChar(commandOrder[mid], cmdLen) < ch){
+      lo = mid + 1;
+    }
+    else{
+      hi = mid;
+    }
+  }
+  cmdLo = lo;
+  
+  //first command in the range whose character at this position is > c
+  hi = cmdHi;
+  while(lo < hi){
+    mid = (lo + hi)/2;
+    if(commandChar(commandOrder[mid], cmdLen) <= ch){
+      lo = mid + 1;
+    }
+    else{
+      hi = mid;
+    }
+  }
+  cmdHi = lo;
+  
+  if(cmdLen < CMDNAMELEN){
+    cmdLen++;
+  }
+  
+  //the shortest name sorts first, so if any name ends here it is at cmdLo
+  if((cmdLo < cmdHi)&&(commandChar(commandOrder[cmdLo], cmdLen) == 0)){
+    return commandOrder[cmdLo];
+  }
+  return -1;
+}
+
+
+
+/*************************************************************************/
+/*                              feedCommand                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: c, the next character received over Serial1               */
+/*                                                                       */
+/* returns: a boolean that is true once the command is complete (it was  */
+/*                 dispatched, or it was not a command and was dropped)  */
+/*                                                                       */
+/* This function builds a command one character at a time. Until the     */
+/* name of a command is complete the character is matched against the    */
+/* command table. A command that takes no argument is complete on the    */
+/* carriage return. A command that takes a value is complete as soon as  */
+/* its name matches, then the value is collected (spaces are skipped) up */
+/* to the carriage return. ARG_NOW commands are complete on their name.  */
+/*                                                                       */
+/*************************************************************************/
+
+boolean feedCommand(char c){
+  byte argType;
+  
+  //ignore null characters, they can't be part of a command
+  if(c == '\0'){
+    return false;
+  }
+  
+  //still matching the name of the command
+  if((cmdMatch < 0)||(pgm_read_byte(&commands[cmdMatch].argType) == ARG_NONE)){
+    if(c == '\r'){
+      //an empty line matches the row with the empty name, it always sorts first
+      if((cmdLen == 0)&&(commandChar(commandOrder[0], 0) == 0)){
+        cmdMatch = commandOrder[0];
+      }
+      dispatchCommand(cmdMatch);
+      resetCommand();
+      return true;
+    }
+    cmdMatch = matchCommandChar(c);
+    if(cmdMatch >= 0){
+      argType = pgm_read_byte(&commands[cmdMatch].argType);
+      if(argType == ARG_NOW){
+        dispatchCommand(cmdMatch);
+        resetCommand();
+        return true;
+      }
+    }
+    return false;
+  }
+  
+  //collecting the value of a command that takes one
+  if(c == '\r'){
+    dispatchCommand(cmdMatch);
+    resetCommand();
+    return true;
+  }
+  if((c != ' ')&&(argLen < ARGBUFFSIZE - 1)){
+    argBuff[argLen++] = c;
+    argBuff[argLen] = '\0';
+  }
+  return false;
+}
+
+
+
+/*************************************************************************/
+/*                             dispatchCommand                           */
+/*                             ***************                           */
+/*                                                                       */
+/* parameters: index, the row of the command table that was received     */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function calls the handler of a complete command. Commands that  */
+/* are flagged CMD_NOTCP are ignored while in continuous profiling mode. */
+/* A command that takes a value is handed the number parsed from the     */
+/* text that followed it ("off" is OFF) and the text itself; a command   */
+/* that takes no value is handed its own name as the text.               */
+/*                                                                       */
+/*************************************************************************/
+
+void dispatchCommand(int index){
+  char name[CMDNAMELEN];
+  CommandHandler handler;
+  
+  trace(TRACE_RX, index);
+  if(index < 0){
+    return;
+  }
+  startStats(index, clockMicros());
+  
+  //a command received at a new baud rate confirms it, keep it for after a reset
+  if(baudState == BAUD_CONFIRM){
+    baudState = BAUD_SET;
+    EEPROM.put(BAUDADDRESS, baudRate);
+  }
+  if((pgm_read_byte(&commands[index].flags) & CMD_NOTCP)&&(cpMode == 1)){
+    return;
+  }
+  handler = (CommandHandler)pgm_read_ptr(&commands[index].handler);
+  if(pgm_read_byte(&commands[index].argType) == ARG_NONE){
+    strcpy_P(name, commands[index].name);
+    handler(0, name);
+  }
+  else{
+    handler(parseValue(argBuff), argBuff);
+  }
+}
+
+
+
+/*************************************************************************/
+/*                            command handlers                           */
+/*                            ****************                           */
+/*                                                                       */
+/* parameters: value, the number sent after a command that takes one     */
+/*             text, the text sent after a command that takes one, or    */
+/*                 the name of the command for one that takes none       */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* One handler for each row of the command table, they build the reply   */
+/* for the command and send it over Serial1 as a series of bytes.        */
+/*                                                                       */
+/*************************************************************************/
+
+//if the input is a carriage return, send back the sbe command prompt (S>)
+void cmdPrompt(long value, const char *text){
+  String cmdMode = "\r\nS>";
+  writeBytes(cmdMode);
+}
+
+//if the input is the i*l command, send back a list of the mission parameters
+void cmdListParameters(long value, const char *text){
+  updateTime();
+  long numbers[8] = {preludeDisplay, parkPressure, parkDescentTimeDisplay, downTimeDisplay,
+                     deepProfilePressure, deepProfileDescentTimeDisplay, ascentTimeOutDisplay,
+                     missionTimeDisplay};
+  writeFlash(listText, numbers, NULL);
+}
+
+//if the input is the i*s command, send back a list of the times for the phases
+//in seconds
+void cmdListPhases(long value, const char *text){
+  updateTime();
+    
+  String listParams = "\r\nMission Time: "+String(long(missionTime/1000)) +
+  "\r\nPhase of mission cycle: "+ phase[currentPhase] +
+  "\r\nPark Descent: " + String(((parkDescentTime)/1000)) +
+  "\r\nPark: " + String(long((downTime-deepProfileDescentTime)/1000)) +
+  "\r\nDeep Descent: " + String(long(downTime/1000)) +
+  "\r\nAscent: " + String(long((downTime+ascentTime)/1000)) + 
+  "\r\nS>";
+  writeBytes(listParams);
+}
+
+//if the input is the e command, start the mission
+void cmdStartMission(long value, const char *text){
+  String start = "\r\nstart mission\r\nS>";
+  writeBytes(start);
+  prelude = 1;
+  currentPhase = PRELUDE;
+}
+
+//if the input is start, skip the prelude and start the mission right away
+void cmdManualStart(long value, const char *text){
+  String manualStart = "\r\nmanual start activated\r\nS>";
+  writeBytes(manualStart);
+  lastUpdate = missionClock() - 80000;
+  
+  missionMode+=110;
+  
+  prelude = -1;
+}
+
+//if the input is the k command, end the mission and reset all of the parameters
+void cmdEndMission(long value, const char *text){
+  String m_end = "\r\nmission ended\r\nS>";
+  writeBytes(m_end);
+  missionMode = 0;
+  currentPhase = PRESSUREACTIVATION;
+  parkDescentTime = 18000000;
+  parkDescentTimeDisplay = 300;
+  parkPressure = PARKPRESSUREDEFAULT;
+  downTime = 86400000;
+  downTimeDisplay = 1440;
+  deepProfileDescentTime = 18000000;
+  deepProfileDescentTimeDisplay = 300;
+  deepProfilePressure = DEEPPROFILEPRESSUREDEFAULT;
+  ascentTimeOut = 36000000;
+  ascentTimeOutDisplay = 600;
+  missionTime = 0;
+  missionTimeDisplay=0;
+  pauseMissionClock(false);
+  setAscentTimes();
+  buildMissionSchedule();
+}
+
+//if the input is pause mission, stop the mission clock, the mission stays
+//where it is until it is resumed
+void cmdPauseMission(long value, const char *text){
+  String m_paused = "\r\nmission paused\r\nS>";
+  writeBytes(m_paused);
+  pauseMissionClock(true);
+}
+
+//if the input is resume mission, start the mission clock again from where
+//it was paused
+void cmdResumeMission(long value, const char *text){
+  String m_resume = "\r\nresuming mission\r\nS>";
+  writeBytes(m_resume);
+  pauseMissionClock(false);
+}
+
+//if the input is mtk<val>, use the value as the park descent time in minutes,
+//calculate the value of the park descent time in milliseconds, then send the value of park descent time as 
+//a series of bytes, confirm that the value has actually changed by using the global variable value 
+//in this echo
+void cmdParkDescentTime(long value, const char *text){
+  parkDescentTimeDisplay = value;
+  parkDescentTime=(parkDescentTimeDisplay*60000);
+  parkDescentTimeCopy = parkDescentTime;
+  buildMissionSchedule();
+  String parkDescentTimeStr = "\r\nS>parkDescentTime="+String(parkDescentTimeDisplay)+"\r\nS>";
+  writeBytes(parkDescentTimeStr);
+}
+
+//if the input is mtp<val>, use the value as the prelude time in minutes, then send the value 
+//of the prelude as a series of bytes, confirm that the value has actually changed by using the 
+//global variable value in this echo
+void cmdPreludeTime(long value, const char *text){
+  preludeDisplay=value;
+  String preludeStr = "\r\nS>prelude="+String(preludeDisplay)+"\r\nS>";
+  writeBytes(preludeStr);
+}
+
+//if the input is mk<val>, use the value as the park pressure in dbar, recalculate the ascent
+//times, then send the value of park pressure as a series of bytes, confirm that the value has
+//actually changed by using the global variable value in this echo
+void cmdParkPressure(long value, const char *text){
+  parkPressure = value;
+  setAscentTimes();
+  buildMissionSchedule();
+  String parkPressureStr = "\r\nS>parkPressure="+String(parkPressure)+"\r\nS>";
+  writeBytes(parkPressureStr);
+}
+
+//if the input is mtd<val>, use the value as the down time in minutes,
+//calculate the value of the down time in milliseconds, then send the value of down time as 
+//a series of bytes, confirm that the value has actually changed by using the global variable value 
+//in this echo
+void cmdDownTime(long value, const char *text){
+  downTimeDisplay = value;
+  downTime = downTimeDisplay*60000LL;
+  downTimeCopy = downTime;
+  buildMissionSchedule();
+  String downTimeStr = "\r\nS>downTime="+String(downTimeDisplay)+"\r\nS>";
+  writeBytes(downTimeStr);
+}
+
+//if the input is mtj<val>, use the value as the deep profile descent time in minutes,
+//calculate the value of the deep profile descent time in milliseconds,
+//then send the value of deep profile descent time as a series of bytes, confirm that the value 
+//has actually changed by using the global variable value in this echo
+void cmdDeepProfileDescentTime(long value, const char *text){
+  deepProfileDescentTimeDisplay = value;
+  deepProfileDescentTime = (deepProfileDescentTimeDisplay*60000);
+  deepProfileDescentTimeCopy = deepProfileDescentTime;
+  buildMissionSchedule();
+  String deepProfileDescentTimeStr = "\r\nS>deepProfileDescentTime="+String(deepProfileDescentTimeDisplay)+"\r\nS>";
+  writeBytes(deepProfileDescentTimeStr);
+}
+
+//if the input is mj<val>, use the value as the deep profile pressure in dbar, recalculate
+//the ascent times, then send the value of deep profile pressure as a series of bytes, confirm 
+//that the value has actually changed by using the global variable value in this echo
+void cmdDeepProfilePressure(long value, const char *text){
+  deepProfilePressure = value;
+  setAscentTimes();
+  buildMissionSchedule();
+  String deepProfilePressureStr = "\r\nS>deepProfilePressure="+String(deepProfilePressure)+"\r\nS>";
+  writeBytes(deepProfilePressureStr);
+}
+
+//if the input is mta<val>, use the value as the ascent timeout in minutes,
+//calculate the value of the ascent timeout in milliseconds, then send the value of ascent timeout as 
+//a series of bytes, confirm that the value has actually changed by using the global variable value 
+//in this echo
+void cmdAscentTimeOut(long value, const char *text){
+  ascentTimeOutDisplay = value;
+  ascentTimeOut=(ascentTimeOutDisplay*60000);
+  ascentTimeOutCopy = ascentTimeOut;
+  String ascentTimeOutStr = "\r\nS>ascentTimeOut="+String(ascentTimeOutDisplay)+"\r\nS>";
+  writeBytes(ascentTimeOutStr);
+}
+
+//if the input is i*t<val>, use the value as the mission time in seconds,
+//calculate the value of the mission time in milliseconds, then send the value of mission time as 
+//a series of bytes, confirm that the value has actually changed by using the global variable value 
+//in this echo. the mission time can only be moved within the current phase
+void cmdMissionTime(long value, const char *text){
+  newTimeDisplay = value;
+  newTime = newTimeDisplay*1000LL;
+  if(newTime >= 0){
+    phaseChange = schedule[missionStep(newTime)].phase;
+  }
+  if(phaseChange==currentPhase){
+    missionTimeDisplay = newTimeDisplay;
+    missionTime = newTime;
+    lastUpdate = missionClock();
+    String missionTimeStr = "\r\nS>missionTime="+String(missionTimeDisplay)+" ("+String((missionTimeDisplay/60))+" minutes)\r\nS>";
+    writeBytes(missionTimeStr);
+  }
+  else{
+    String no = "\r\nS>Cannot move time to a different phase";
+    writeBytes(no);
+  }
+}
+
+//if the input is ascentRate=<val>, use the value as the ascent rate in cm/s, recalculate
+//the ascent times, then send the value of ascent rate as a series of bytes, confirm that the 
+//value has actually changed by using the global variable value in this echo
+void cmdAscentRate(long value, const char *text){
+  ascentRate = value;
+  setAscentTimes();
+  buildMissionSchedule();
+  char ascentRateStr[REPLYSIZE];
+  char *end = appendChars(ascentRateStr, "\r\nS>ascentRate=");
+  end = pressureToChars(end, ascentRate*100L);
+  appendChars(end, " cm/s\r\nS>");
+  writeBytes(ascentRateStr);
+}
+
+//if the input is show <name>, send back the value of the named mission parameter (and its copy
+//for the ones that have one) as a series of bytes
+void cmdShow(long value, const char *text){
+  updateTime();
+  String input = text;
+  String str; 
+  char number[2][21];
+  if(input.equals("missionTime")){
+   longLongToChars(number[0], missionTime);
+   longLongToChars(number[1], missionTimeCopy);
+   str= "\r\nS>"+input+"="+String(number[0])+
+   "\r\nS>"+input+"="+String(number[1]);
+  }
+  else if(input.equals("parkPressure")){
+   str= "\r\nS>"+input+"="+String(parkPressure);
+  }
+  else if(input.equals("deepProfilePressure")){
+   str= "\r\nS>"+input+"="+String(deepProfilePressure);
+  }
+  else if(input.equals("parkDescentTime")){
+   str= "\r\nS>"+input+"="+String(parkDescentTime)+
+   "\r\nS>"+input+"="+String(parkDescentTimeCopy);
+  }
+  else if(input.equals("downTime")){
+   longLongToChars(number[0], downTime);
+   longLongToChars(number[1], downTimeCopy);
+   str= "\r\nS>"+input+"="+String(number[0])+
+   "\r\nS>"+input+"="+String(number[1]);
+  }
+  else if(input.equals("prelude")){
+   str= "\r\nS>"+input+"="+String(preludeDisplay);
+  }
+  else if(input.equals("deepProfileDescentTime")){
+   str= "\r\nS>"+input+"="+String(deepProfileDescentTime)+
+   "\r\nS>"+input+"="+String(deepProfileDescentTimeCopy);
+  }
+  else if(input.equals("ascentTimeOut")){
+   str= "\r\nS>"+input+"="+String(ascentTimeOut)+
+   "\r\nS>"+input+"="+String(ascentTimeOut);
+  }
+  writeBytes(str);
+  missionMode++;
+}
+
+//if the input is the ds command, send back all of the information as a series of bytes (uses generic
+//info based on an actual seabird, can edit field in this string if necessary), there should be 3 
+//fields that will vary: the number of bins, number of samples, the bin settings, and whether it is 
+//expecting only P or pts for real time output
+void cmdDisplayStatus(long value, const char *text){
+#if HAS_CP
+  long numbers[10] = {count, nBins, topBinInterval, topBinSize, topBinMax, middleBinInterval,
+                      middleBinSize, middleBinMax, bottomBinInterval, bottomBinSize};
+  const char *texts[1] = {pOrPTS[pOrPTSsel]};
+#else
+  long *numbers = NULL;
+  const char *texts[3] = {pumpFast[pumpFastSel], noOrYes[addDelaysSel], noOrYes[outputDensitySel]};
+#endif
+  writeFlash(dsText, numbers, texts);
+}
+
+//if the input is the dc command, send back all of the information as a series of bytes (uses generic
+//info based on an actual seabird (can edit field in this string if necessary)
+void cmdDisplayCalibration(long value, const char *text){
+#if HAS_OXYGEN
+  char tau[12], ns[12], nf[12];
+  const char *texts[3] = {tau, ns, nf};
+  digitsToChars(appendChars(longToChars(tau, OXYGENTAU20/100), "."), OXYGENTAU20%100, 2);
+  tenthsToChars(ns, oxygenNs, 1);
+  tenthsToChars(nf, oxygenNf, 1);
+  writeFlash(dcText, NULL, texts);
+#else
+  writeFlash(dcText, NULL, NULL);
+#endif
+}
+
+//if the input is startprofile, recognize that it is the start profile command,
+//turn on continuous profiling mode, then ~0.5 sec from now (profileStartJob) send 
+//back that the profile has started, reattach interrupt to pin2, and start sampling
+void cmdStartProfile(long value, const char *text){
+  updateTime();
+  //reinitalize values
+  maxPress = 0;
+  minPress = 10000;
+  resetBins();
+  da = -1;
+  inc = 0;
+  cpMode = 1;
+  String cp = "\r\nS>startprofile";
+  writeBytes(cp);
+  startJob(JOB_PROFILESTART, 500);
+}
+
+//if the input is stopprofile, recognize that it is the stop profile command,
+//then send back that the profile has stopped, ignore the external interrupt
+//on pin2, and turn off continuous profiling mode
+void cmdStopProfile(long value, const char *text){
+  cpMode = -1;
+  String exitcp = PROFILESTOPPED;
+  writeBytes(exitcp);
+}
+
+//if the input is binaverage, return the number of samples and bins averaged as they were
+//sent during continuous profiling mode. set da to 1 which will allow for the
+//da command to be run (makes sure there is actual data to dump when requested)
+void cmdBinAverage(long value, const char *text){
+  char binavg[2*REPLYSIZE];
+  char *end = appendChars(binavg, "\r\nS>binaverage\r\nsamples = ");
+  end = longToChars(end, count);
+  end = appendChars(end, ", maxPress = ");
+  end = pressureToChars(end, long(maxPress*100));
+  end = appendChars(end, "\r\nrd: 0\r\navg: 0\r\n\r\ndone, nbins = ");
+  end = longToChars(end, nBins);
+  appendChars(end, "\r\nS>");
+  writeBytes(binavg);
+  da = 1;
+}
+
+//if the inpt is da, send bins in the format "p, t, s, b" (pressure,
+//temperature, salinity, number of samples) over Serial1. then send that 
+//the upload is done. the bins are sent one at a time from loop() by serviceUpload
+void cmdDumpAverages(long value, const char *text){
+  startUpload(UPLOAD_DA);
+}
+
+//if the inpt is dah, send bins in the hex format "ppppttttssssbb" (pressure,
+//temperature, salinity, number of samples) over Serial1. then send that 
+//the upload is done. the bins are sent one at a time from loop() by serviceUpload
+void cmdDumpAveragesHex(long value, const char *text){
+  startUpload(UPLOAD_DAH);
+}
+
+//if the inpt is dab, send bins as packed binary records (pressure, temperature, salinity,
+//number of samples) after a header with the number of bins and the size of a record, then
+//a CRC of the header and bins. then send that the upload is done. the bins are sent one at
+//a time from loop() by serviceUpload
+void cmdDumpAveragesBinary(long value, const char *text){
+  startUpload(UPLOAD_DAB);
+}
+
+//if the input is dd, send every sample of the profile from the deepest to the shallowest
+//in the format "p, t, s" (or "p" for p only real-time output), then send that the upload is done.
+//the samples are sent one at a time from loop() by serviceUpload
+void cmdDumpData(long value, const char *text){
+  startUpload(UPLOAD_DD);
+}
+
+//if the input is dumptrace, send the events in the trace from the oldest as packed binary
+//records (time, event, data) after a header with the number of events and the size of a
+//record, then a CRC of the header and events, like dab. then send that the upload is done
+void cmdDumpTrace(long value, const char *text){
+  startUpload(UPLOAD_TRACE);
+}
+
+//if the input is stats, send back for each command and hardware line request since the last
+//reset: how many were answered, the min, mean and max latency (us, from the carriage return or
+//the rise of the request line to the first byte of the reply) and reply size (bytes), and
+//the histograms of both (each bucket 4 times as wide as the last)
+void cmdStats(long value, const char *text){
+  startUpload(UPLOAD_STATS);
+}
+
+//if the input is stats reset, clear the statistics and start them over from now
+void cmdStatsReset(long value, const char *text){
+  memset(stats, 0, sizeof(stats));
+  statsUsed = 0;
+  statsSince = clockMillis();
+  statsKey = STATSOTHER;
+  statsWaiting = false;
+  String reset = "\r\nstats reset\r\nS>";
+  writeBytes(reset);
+}
+
+//if the input is replay, send back whether the samples come from the recorded profile, how many
+//records it has, the pressures it spans and how many samples had to wait for their window
+void cmdReplay(long value, const char *text){
+  char first[REPLYSIZE], last[REPLYSIZE];
+  if(replayCount == 0){
+    String none = "\r\nno recorded profile\r\nS>";
+    writeBytes(none);
+    return;
+  }
+  *pressureToChars(first, replayRecordPressure(0)) = '\0';
+  *pressureToChars(last, replayRecordPressure(replayCount - 1)) = '\0';
+  String replay = "\r\nreplay "+String(replayOn ? "on" : "off")+", "+String(replayCount)+" records"+
+  String(replayOxygen ? " with oxygen" : "")+" from"+String(first)+" to"+String(last)+" dbar, "+
+  String(replayMisses)+" misses\r\nS>";
+  writeBytes(replay);
+}
+
+//if the input is replay on, open the recorded profile again and take the samples from it, the
+//water column is used if there isn't one
+void cmdReplayOn(long value, const char *text){
+  replayOn = startReplay();
+  if(!replayOn){
+    String none = "\r\nno recorded profile\r\nS>";
+    writeBytes(none);
+    return;
+  }
+  String replayOnMsg = "\r\nreplay on, "+String(replayCount)+" records\r\nS>";
+  writeBytes(replayOnMsg);
+}
+
+//if the input is replay off, take the samples from the water column again
+void cmdReplayOff(long value, const char *text){
+  replayOn = false;
+  String replayOffMsg = "\r\nreplay off\r\nS>";
+  writeBytes(replayOffMsg);
+}
+
+//if the input is store, send back the run number and, for each file recorded to the SD card,
+//the blocks written of the blocks it has, how many of them are on the card yet, the records
+//waiting in memory and the records dropped
+void cmdStore(long value, const char *text){
+  int i;
+  String list = "\r\nrun "+String(storeRun);
+  for(i = 0; i < STORAGEFILES; i++){
+    list += "\r\n"+String(stores[i].name)+" ";
+    if(!stores[i].open){
+      list += "no card";
+      continue;
+    }
+    list += String(stores[i].written)+"/"+String(stores[i].blocks)+" blocks, "+
+    String(stores[i].allocated)+" made, "+
+    String((i == STORE_TRACE) ? storeTraceWaiting : (stores[i].fillLen - STOREHEADERSIZE)/stores[i].recordSize)+" waiting, "+
+    String(stores[i].dropped)+" dropped";
+  }
+  list += "\r\nS>";
+  writeBytes(list);
+}
+
+//if the input is noise, send back the noise model: on or off, the seed, the sigma of each channel,
+//the spike and dropout rates (per thousand samples) and how many spikes and dropouts there have been
+void cmdNoise(long value, const char *text){
+  String noise = "\r\nnoise "+String(noiseOn ? "on" : "off")+", seed "+String((unsigned long)noiseSeed)+
+  ", p "+String(noiseSigma[NOISE_P])+" t "+String(noiseSigma[NOISE_T])+" s "+String(noiseSigma[NOISE_S])+
+  " o "+String(noiseSigma[NOISE_O])+", spike "+String(noiseSpike)+" dropout "+String(noiseDropout)+
+  ", "+String(noiseSpikes)+" spikes "+String(noiseDropouts)+" dropouts\r\nS>";
+  writeBytes(noise);
+}
+
+//if the input is noise off, set every sigma and rate to 0, so the samples are exact again
+void cmdNoiseOff(long value, const char *text){
+  memset(noiseSigma, 0, sizeof(noiseSigma));
+  noiseSpike = 0;
+  noiseDropout = 0;
+  noiseOn = false;
+  String noiseOff = "\r\nnoise off\r\nS>";
+  writeBytes(noiseOff);
+}
+
+//if the input is noise seed=<val>, start the random numbers of the noise model over from that
+//seed (0 is taken as 1, xorshift can't start from 0), the same seed gives the same noise
+void cmdNoiseSeed(long value, const char *text){
+  noiseSeed = (value == 0) ? 1 : uint32_t(value);
+  noiseState = noiseSeed;
+  noiseSpikes = 0;
+  noiseDropouts = 0;
+  String seed = "\r\nnoise seed="+String((unsigned long)noiseSeed)+"\r\nS>";
+  writeBytes(seed);
+}
+
+//if the input is noise p=<val>, noise t=<val>, noise s=<val> or noise o=<val>, set the standard
+//deviation of the noise of pressure (hundredths of a dbar), temperature, salinity (ten
+//thousandths) or oxygen (Hz)
+void cmdNoiseP(long value, const char *text){
+  setNoise(&noiseSigma[NOISE_P], value, NOISESIGMAMAX, "p=", text);
+}
+
+void cmdNoiseT(long value, const char *text){
+  setNoise(&noiseSigma[NOISE_T], value, NOISESIGMAMAX, "t=", text);
+}
+
+void cmdNoiseS(long value, const char *text){
+  setNoise(&noiseSigma[NOISE_S], value, NOISESIGMAMAX, "s=", text);
+}
+
+void cmdNoiseO(long value, const char *text){
+  setNoise(&noiseSigma[NOISE_O], value, NOISESIGMAMAX, "o=", text);
+}
+
+//if the input is noise spike=<val> or noise dropout=<val>, set how many samples in a thousand get
+//a spike or drop out (aren't sent)
+void cmdNoiseSpike(long value, const char *text){
+  setNoise(&noiseSpike, value, NOISERATEMAX, "spike=", text);
+}
+
+void cmdNoiseDropout(long value, const char *text){
+  setNoise(&noiseDropout, value, NOISERATEMAX, "dropout=", text);
+}
+
+//if the input is oxygen, send back how the SBE43F is set up (Nf, Ns, TAU_20) and the pump time
+//of the last PTSO sample, then how many there have been and how long the pump has run for them
+void cmdOxygen(long value, const char *text){
+  char nf[12], ns[12], pump[12], total[12];
+  tenthsToChars(nf, oxygenNf, 1);
+  tenthsToChars(ns, oxygenNs, 1);
+  tenthsToChars(pump, oxygenPump/100, 1);
+  tenthsToChars(total, oxygenPumpTotal/100, 1);
+  String oxygen = "\r\noxygen "+String((oxygenNf > 0) ? "on" : "off")+", nf "+String(nf)+" ns "+String(ns)+
+  ", tau20 "+String(OXYGENTAU20/100.0)+" sec, pump "+String(pump)+" sec, "+String(oxygenSamples)+
+  " samples "+String(total)+" sec\r\nS>";
+  writeBytes(oxygen);
+}
+
+//if the input is oxnf=<val> or oxns=<val> (tenths, oxnf=2.0), set how many time constants the
+//SBE43F pumps for before a sample and echo the input, a PTS request gets oxygen once Nf is set
+void cmdOxygenNf(long value, const char *text){
+  long tenths = parseTenths(text);
+  if((tenths < 0)||(tenths > OXYGENNMAX)){
+    String badNf = "\r\noxnf="+String(text)+" not supported\r\nS>";
+    writeBytes(badNf);
+    return;
+  }
+  oxygenNf = tenths;
+  String echo = "\r\nS>oxnf="+String(text);
+  replyLater(echo.c_str(), 10, false);
+}
+
+void cmdOxygenNs(long value, const char *text){
+  long tenths = parseTenths(text);
+  if((tenths < 0)||(tenths > OXYGENNMAX)){
+    String badNs = "\r\noxns="+String(text)+" not supported\r\nS>";
+    writeBytes(badNs);
+    return;
+  }
+  oxygenNs = tenths;
+  String echo = "\r\nS>oxns="+String(text);
+  replyLater(echo.c_str(), 10, false);
+}
+
+//if the input is store sync, write the records waiting in memory to the SD card too (in
+//blocks that are partly filled), from the store job
+void cmdStoreSync(long value, const char *text){
+  storeSync = true;
+  String sync = "\r\nstore sync\r\nS>";
+  writeBytes(sync);
+}
+
+//if the input is qsr (qs on the SBE41 STD), send back that the seabird is powering down as a
+//series of bytes (the simulator will just stay on and wait for the next interaction with the APFx)
+void cmdPowerDown(long value, const char *text){
+#if HAS_CP
+  String cmdMode = "\r\nS>qsr\r\npowering down\r\nS>";
+  writeBytes(cmdMode);
+  replyLater("", 700, true);
+#else
+  String cmdMode = "\r\nS>qs\r\nS>";
+  writeBytes(cmdMode);
+  replyLater("", 100, true);
+#endif
+}
+
+//if the input is pumpfastpt=y or pumpfastpt=n, outputdensity=y or outputdensity=n,
+//addtimingdelays=y or addtimingdelays=n, change the setting shown by ds and echo the input
+void cmdPumpFast(long value, const char *text){
+  pumpFastSel = (text[strlen(text)-1] == 'y');
+  cmdEcho(value, text);
+}
+
+void cmdOutputDensity(long value, const char *text){
+  outputDensitySel = (text[strlen(text)-1] == 'y');
+  cmdEcho(value, text);
+}
+
+void cmdTimingDelays(long value, const char *text){
+  addDelaysSel = (text[strlen(text)-1] == 'y');
+  cmdEcho(value, text);
+}
+
+//if the input is build, send back the controller the simulator is
+void cmdBuild(long value, const char *text){
+  String build = "\r\nAPF-11\r\nS>";
+  writeBytes(build);
+}
+
+//if the input is one of the configuration commands that don't change the simulation
+//(autobinavg=n, pcutoff=2.0, tswait=20, the bin settings...), send back the command
+//prompt and echo the input as a series of bytes
+void cmdEcho(long value, const char *text){
+  String echo = "\r\nS>"+String(text);
+  replyLater(echo.c_str(), 10, false);
+}
+
+//if the input is one of the bin settings (top_bin_interval=<val>, top_bin_size=<val>, top_bin_max=<val>,
+//middle_bin_interval=<val>, middle_bin_size=<val>, middle_bin_max=<val>, bottom_bin_interval=<val>,
+//bottom_bin_size=<val>), change the setting used to average the next profile and echo the input
+void cmdTopBinInterval(long value, const char *text){
+  setBinSetting(&topBinInterval, value, "top_bin_interval=", text);
+}
+
+void cmdTopBinSize(long value, const char *text){
+  setBinSetting(&topBinSize, value, "top_bin_size=", text);
+}
+
+void cmdTopBinMax(long value, const char *text){
+  setBinSetting(&topBinMax, value, "top_bin_max=", text);
+}
+
+void cmdMiddleBinInterval(long value, const char *text){
+  setBinSetting(&middleBinInterval, value, "middle_bin_interval=", text);
+}
+
+void cmdMiddleBinSize(long value, const char *text){
+  setBinSetting(&middleBinSize, value, "middle_bin_size=", text);
+}
+
+void cmdMiddleBinMax(long value, const char *text){
+  setBinSetting(&middleBinMax, value, "middle_bin_max=", text);
+}
+
+void cmdBottomBinInterval(long value, const char *text){
+  setBinSetting(&bottomBinInterval, value, "bottom_bin_interval=", text);
+}
+
+void cmdBottomBinSize(long value, const char *text){
+  setBinSetting(&bottomBinSize, value, "bottom_bin_size=", text);
+}
+
+//if the input is outputpts=y, send back the command prompt and echo the input as a series of bytes
+//and change pOrPTSsel to 1 so that the ds command will display pts
+void cmdOutputPTS(long value, const char *text){
+  replyLater("\r\nS>outputpts=y", 10, false);
+  pOrPTSsel = 1;
+}
+
+//if the input is outputpts=n, send back the command prompt and echo the input as a series of bytes
+//and set pOrPTSsel to 0 so that the ds command will display p only
+void cmdOutputP(long value, const char *text){
+  replyLater("\r\nS>outputpts=n", 10, false);
+  pOrPTSsel = 0;
+}
+
+//if the input is constantP=<val>, hold the pressure of every reading at the value,
+//constantP=off goes back to calculating the pressure
+void cmdConstantP(long value, const char *text){
+  constantP=value;
+  if(constantP==OFF){
+    constant = -1;
+  }
+  else{
+    constant = 1;
+  }
+}
+
+//if the input is id, send back that the seabird is in ice detect mode as a series of bytes 
+//change the global variable ice avoidance to 1, which is detect mode. also assume ice will
+//be detected at 20 dbar
+void cmdIceDetect(long value, const char *text){
+  iceAvoidance = ICEDETECT;
+  icePressure = 20;
+  String icedMode = "\r\nice detect mode on\r\nS>";
+  writeBytes(icedMode);
+  buildIceOverlay();
+  buildMissionSchedule();
+}
+
+//if the input is id@<val>, send back that the seabird is in ice detect mode as a series of bytes 
+//change the global variable ice avoidance to 1, which is detect mode. also set ice to be detected 
+//at the given input pressure
+void cmdIceDetectAt(long value, const char *text){
+  icePressure=value;
+  iceAvoidance = ICEDETECT;
+  String icedaMode = "\r\nice detect mode on, will detect ice at "+String(icePressure)+"dbar\r\nS>";
+  writeBytes(icedaMode);
+  buildIceOverlay();
+  buildMissionSchedule();
+}
+
+//if the input is ic, send back that the seabird is in ice cap mode as a series of bytes 
+//change the global variable ice avoidance to 2, which is cap mode
+void cmdIceCap(long value, const char *text){
+  icePressure = 4;
+  iceAvoidance = ICECAP;
+  String icecMode = "\r\nice cap mode on\r\nS>";
+  writeBytes(icecMode);
+  buildIceOverlay();
+  buildMissionSchedule();
+}
+
+//if the input is ic@<val>, send back that the seabird is in ice cap mode as a series of bytes 
+//change the global variable ice avoidance to 2, which is cap mode. also set ice to be detected 
+//at the given input pressure
+void cmdIceCapAt(long value, const char *text){
+  icePressure=value;
+  iceAvoidance = ICECAP;
+  String icecaMode = "\r\nice cap mode on, will detect ice at "+String(icePressure)+"dbar\r\nS>";
+  writeBytes(icecaMode);
+  buildIceOverlay();
+  buildMissionSchedule();
+}
+
+//if the input is ib, send back that the seabird is in ice breakup mode as a series of bytes 
+//change the global variable ice avoidance to 3, which is breakup mode
+void cmdIceBreakup(long value, const char *text){
+  iceAvoidance = ICEBREAKUP;
+  String icebMode = "\r\nice breakup mode on\r\nS>";
+  writeBytes(icebMode);
+  buildIceOverlay();
+  buildMissionSchedule();
+}
+
+//if the input is id off, send back that ice detect mode is off as a series of bytes 
+//change the global variable ice avoidance to -1, which is normal mode
+void cmdIceDetectOff(long value, const char *text){
+  iceAvoidance = NOICE;
+  String icedModeOff = "\r\nice detect mode off\r\nS>";
+  writeBytes(icedModeOff);
+  icePressure=20;
+  buildIceOverlay();
+  buildMissionSchedule();
+}
+
+//if the input is ic off, send back that ice cap mode is off as a series of bytes 
+//change the global variable ice avoidance to -1, which is normal mode
+void cmdIceCapOff(long value, const char *text){
+  iceAvoidance = NOICE;
+  String icecModeOff = "\r\nice cap mode off\r\nS>";
+  writeBytes(icecModeOff);
+  icePressure=20;
+  buildIceOverlay();
+  buildMissionSchedule();
+}
+
+//if the input is ib off, send back that ice breakup mode is off as a series of bytes 
+//change the global variable ice avoidance to -1, which is normal mode
+void cmdIceBreakupOff(long value, const char *text){
+  iceAvoidance = NOICE;
+  String icebModeOff = "\r\nice breakup mode off\r\nS>";
+  writeBytes(icebModeOff);
+  buildIceOverlay();
+  buildMissionSchedule();
+}
+
+//if the input is baud=<val>, send back the new rate at the old rate, then change Serial1
+//to it once the reply is sent (from loop() by serviceBaud). the APFx (or test bench) has to
+//send a command at the new rate to keep it. a rate Serial1 can't run at is refused
+void cmdBaud(long value, const char *text){
+  if(!validBaud(value)){
+    String badBaud = "\r\nbaud rate "+String(text)+" not supported\r\nS>";
+    writeBytes(badBaud);
+    return;
+  }
+  String baud = "\r\nbaud="+String(value)+"\r\nS>";
+  writeBytes(baud);
+  baudNext = value;
+  baudState = BAUD_SWITCH;
+}
+
+//if the input is sched, send back each job of the scheduler, its period (ms), how many times
+//it ran, how many runs it missed because the loop was busy, and the latest (ms) it has run
+void cmdSchedule(long value, const char *text){
+  startUpload(UPLOAD_SCHED);
+}
+
+//if the input is timescale=<val>, run the mission clock val times faster than real time (1 is
+//real time), then send back the new time scale
+void cmdTimeScale(long value, const char *text){
+  if((value < 1)||(value > TIMESCALEMAX)){
+    String badScale = "\r\ntime scale "+String(text)+" not supported (1-"+String(TIMESCALEMAX)+")\r\nS>";
+    writeBytes(badScale);
+    return;
+  }
+  setTimeScale(value);
+  String scale = "\r\ntimescale="+String(timeScale)+"\r\nS>";
+  writeBytes(scale);
+}
+
+//if the input is ?, list the simulation type and all of the options for commands
+void cmdHelp(long value, const char *text){
+  writeFlash(helpText, NULL, NULL);
+}
+
+
+
+/*************************************************************************/
+/*                            buildIceOverlay                            */
+/*                            ***************                            */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function works out the water column near the surface for the ice */
+/* avoidance mode in effect and icePressure, every ICESTEP down to the   */
+/* pressure the mode stops at (iceLimit). It is run whenever one of the  */
+/* ice commands changes them, so the float math is done once here and    */
+/* not for every sample. Ice breakup mode and normal mode use the water  */
+/* column as is.                                                         */
+/*                                                                       */
+/*        ice detect: median temp of <= -1.78 C for 20-50dbar range      */
+/*        ice cap: a temp of <= -1.78 C for surface (or after 20dbar)    */
+/*        ice breakup: a temp of > -1.78 C the whole way up              */
+/*                                                                       */
+/*************************************************************************/
+
+void buildIceOverlay(void){
+  float midway;
+  float pressure;
+  float temperature;
+  int i;
+  
+  if(iceAvoidance == ICEDETECT){
+    iceLimit = 5000;
+    midway = float((50-icePressure)/2) + icePressure;
+  }
+  else if(iceAvoidance == ICECAP){
+    iceLimit = 2000;
+    midway = float((20-icePressure)/2) + icePressure;
+  }
+  else{
+    iceLimit = 0;
+    return;
+  }
+  
+  for(i = 0; i < ICEPOINTS; i++){
+    pressure = float(i*ICESTEP)/100;
+    temperature = (pressure-midway)/midway - 1.8;
+    iceTemperature[i] = long(temperature*10000);
+    iceSalinity[i] = long((temperature*0.1 + 34.9)*10000);
+  }
+}
+
+
+
+/*************************************************************************/
+/*                             getWaterSample                            */
+/*                             **************                            */
+/*                                                                       */
+/* parameters: pressure, a long in hundredths of a dbar                  */
+/*             temperature, salinity, longs that the temperature and     */
+/*                  salinity (in ten thousandths) are written into       */
+/*             oxygen, a long that the oxygen (Hz) is written into, NULL */
+/*                  if it isn't wanted                                   */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function looks up the temperature and salinity at the given      */
+/* pressure, from the ice overlay above iceLimit, from the recorded      */
+/* profile below it when replay is on, and from the waterColumn table    */
+/* everywhere else. The value is interpolated in a straight line         */
+/* between the two rows around the pressure, in fixed point so there is  */
+/* no float math. Past the deepest row the last two rows are extended.   */
+/* The oxygen is from the recorded profile if it has oxygen, and from    */
+/* getOxygenSample everywhere else (the ice doesn't change it).          */
+/*                                                                       */
+/*************************************************************************/
+
+void getWaterSample(long pressure, long *temperature, long *salinity, long *oxygen){
+  long t0, t1, s0, s1;
+  long part;
+  int i;
+  
+  if(oxygen != NULL){
+    *oxygen = getOxygenSample(pressure);
+  }
+  
+  //in the ice overlay
+  if(pressure < iceLimit){
+    i = pressure/ICESTEP;
+    if(i < 0){
+      i = 0;
+    }
+    part = pressure - long(i)*ICESTEP;
+    *temperature = iceTemperature[i] + (iceTemperature[i+1]-iceTemperature[i])*part/ICESTEP;
+    *salinity = iceSalinity[i] + (iceSalinity[i+1]-iceSalinity[i])*part/ICESTEP;
+    return;
+  }
+  
+  //from the recorded profile
+  if(replayOn){
+    getReplaySample(pressure, temperature, salinity, replayOxygen ? oxygen : NULL);
+    return;
+  }
+  
+  //in the water column, use the last two rows past the bottom of it
+  i = pressure/WATERSTEP;
+  if(i < 0){
+    i = 0;
+  }
+  if(i > NWATERLEVELS-2){
+    i = NWATERLEVELS-2;
+  }
+  part = pressure - long(i)*WATERSTEP;
+  t0 = pgm_read_dword(&waterColumn[i].temperature);
+  t1 = pgm_read_dword(&waterColumn[i+1].temperature);
+  s0 = pgm_read_dword(&waterColumn[i].salinity);
+  s1 = pgm_read_dword(&waterColumn[i+1].salinity);
+  
+  //whole steps then the part of a step, so a pressure far past the bottom can't overflow
+  *temperature = t0 + (t1-t0)*(part/WATERSTEP) + (t1-t0)*(part%WATERSTEP)/WATERSTEP;
+  *salinity = s0 + (s1-s0)*(part/WATERSTEP) + (s1-s0)*(part%WATERSTEP)/WATERSTEP;
+}
+
+
+
+/*************************************************************************/
+/*                            getOxygenSample                            */
+/*                            ***************                            */
+/*                                                                       */
+/* parameters: pressure, a long in hundredths of a dbar                  */
+/*                                                                       */
+/* returns: a long that represents the frequency (Hz) of the SBE43F at   */
+/*          the pressure                                                 */
+/*                                                                       */
+/* This function looks up the oxygen at the given pressure in the        */
+/* oxygenColumn table, interpolated in a straight line between the two   */
+/* rows around it the way getWaterSample does the temperature and        */
+/* salinity. Past the deepest row the last two rows are extended.        */
+/*                                                                       */
+/*************************************************************************/
+
+long getOxygenSample(long pressure){
+  long o0, o1;
+  long part;
+  int i;
+  
+  i = pressure/WATERSTEP;
+  if(i < 0){
+    i = 0;
+  }
+  if(i > NWATERLEVELS-2){
+    i = NWATERLEVELS-2;
+  }
+  part = pressure - long(i)*WATERSTEP;
+  o0 = pgm_read_word(&oxygenColumn[i]);
+  o1 = pgm_read_word(&oxygenColumn[i+1]);
+  return o0 + (o1-o0)*(part/WATERSTEP) + (o1-o0)*(part%WATERSTEP)/WATERSTEP;
+}
+
+
+
+/*************************************************************************/
+/*                              startReplay                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: a boolean that is true if there is a recorded profile        */
+/*                                                                       */
+/* This function opens the recorded profile (replayOpen), checks its     */
+/* header and reads in its first window. The file is a 16 byte header,   */
+/* "APFR", the version (2 bytes), the size of a record (2 bytes), the    */
+/* number of records (4 bytes) and the flags (4 bytes), then the records */
+/* (ReplayRecord) sorted by pressure, all little endian like the Mega.   */
+/*                                                                       */
+/*************************************************************************/
+
+boolean startReplay(void){
+  byte buffer[REPLAYHEADERSIZE];
+  const byte *header;
+  long size = replayOpen();
+  
+  replayCount = 0;
+  replayWindows = 0;
+  replayWindowNo[0] = replayWindowNo[1] = -1;
+  replayNext = -1;
+  replayMisses = 0;
+  if(size < REPLAYHEADERSIZE){
+    return false;
+  }
+  header = replayRead(0, buffer, REPLAYHEADERSIZE);
+  if((header == NULL)||(memcmp(header, "APFR", 4) != 0)){
+    return false;
+  }
+  if((header[4] + (header[5] << 8) != REPLAYVERSION)||
+  (header[6] + (header[7] << 8) != int(sizeof(ReplayRecord)))){
+    return false;
+  }
+  replayCount = header[8] + (long(header[9]) << 8) + (long(header[10]) << 16) + (long(header[11]) << 24);
+  replayOxygen = (header[12] & REPLAY_OXYGEN) != 0;
+  if((replayCount < 1)||(size < REPLAYHEADERSIZE + replayCount*long(sizeof(ReplayRecord)))){
+    replayCount = 0;
+    return false;
+  }
+  
+  //windows overlap by a record, so two records in a row are always in one of them
+  replayWindows = (replayCount <= REPLAYWINDOW) ? 1 : (replayCount - 2)/(REPLAYWINDOW - 1) + 1;
+  replayAt = 0;
+  if(!loadReplayWindow(0, 0)){
+    replayCount = 0;
+    return false;
+  }
+  replayPressure = replayWindow[0][0].pressure;
+  return true;
+}
+
+
+
+/*************************************************************************/
+/*                          replayRecordPressure                         */
+/*                          ********************                         */
+/*                                                                       */
+/* parameters: record, a long that represents the record of the recorded */
+/*                  profile                                              */
+/*                                                                       */
+/* returns: a long that represents the pressure of the record (hundredths*/
+/*                  of a dbar)                                           */
+/*                                                                       */
+/* This function reads the pressure of a record straight from the file,  */
+/* for finding a window without reading it in.                           */
+/*                                                                       */
+/*************************************************************************/
+
+long replayRecordPressure(long record){
+  int32_t pressure = 0;
+  const byte *bytes = replayRead(REPLAYHEADERSIZE + record*sizeof(ReplayRecord), (byte *)&pressure, sizeof(pressure));
+  if(bytes != NULL){
+    memcpy(&pressure, bytes, sizeof(pressure));
+  }
+  return pressure;
+}
+
+
+
+/*************************************************************************/
+/*                            loadReplayWindow                           */
+/*                            ****************                           */
+/*                                                                       */
+/* parameters: buffer, a byte that represents which of replayBuffer to   */
+/*                  read into                                            */
+/*             window, a long that represents the window to read in      */
+/*                                                                       */
+/* returns: a boolean that is true if the window could be read           */
+/*                                                                       */
+/* This function reads a window of the recorded profile into a buffer.   */
+/* Window w is the REPLAYWINDOW records from w*(REPLAYWINDOW-1), the last*/
+/* one may be shorter. On Linux the file is memory mapped, so the window */
+/* is only pointed at and nothing is copied.                             */
+/*                                                                       */
+/*************************************************************************/
+
+boolean loadReplayWindow(byte buffer, long window){
+  long first = window*(REPLAYWINDOW - 1);
+  long len = replayCount - first;
+  const byte *records;
+  
+  if(len > REPLAYWINDOW){
+    len = REPLAYWINDOW;
+  }
+  replayWindowNo[buffer] = -1;
+  records = replayRead(REPLAYHEADERSIZE + first*sizeof(ReplayRecord), (byte *)replayBuffer[buffer], len*sizeof(ReplayRecord));
+  if(records == NULL){
+    return false;
+  }
+  replayWindow[buffer] = (const ReplayRecord *)records;
+  replayWindowLen[buffer] = len;
+  replayWindowNo[buffer] = window;
+  return true;
+}
+
+
+
+/*************************************************************************/
+/*                            findReplayWindow                           */
+/*                            ****************                           */
+/*                                                                       */
+/* parameters: pressure, a long in hundredths of a dbar                  */
+/*                                                                       */
+/* returns: a long that represents the window the pressure is in         */
+/*                                                                       */
+/* This function finds the last window that starts at or above the       */
+/* pressure, a binary search on the first pressure of each window.       */
+/*                                                                       */
+/*************************************************************************/
+
+long findReplayWindow(long pressure){
+  long low = 0, high = replayWindows - 1, middle;
+  
+  while(low < high){
+    middle = (low + high + 1)/2;
+    if(replayRecordPressure(middle*(REPLAYWINDOW - 1)) <= pressure){
+      low = middle;
+    }
+    else{
+      high = middle - 1;
+    }
+  }
+  return low;
+}
+
+
+
+/*************************************************************************/
+/*                              replayCovers                             */
+/*                              ************                             */
+/*                                                                       */
+/* parameters: buffer, a byte that represents which of replayBuffer      */
+/*             pressure, a long in hundredths of a dbar                  */
+/*                                                                       */
+/* returns: a boolean that is true if the window in the buffer can give  */
+/*                  the sample at the pressure                           */
+/*                                                                       */
+/* This function checks a pressure is between the first and last record  */
+/* of the window in a buffer, the first and last window also cover the   */
+/* pressures past the ends of the recorded profile.                      */
+/*                                                                       */
+/*************************************************************************/
+
+boolean replayCovers(byte buffer, long pressure){
+  const ReplayRecord *records = replayWindow[buffer];
+  long window = replayWindowNo[buffer];
+  
+  if(window < 0){
+    return false;
+  }
+  if((window > 0)&&(pressure < records[0].pressure)){
+    return false;
+  }
+  if((window < replayWindows - 1)&&(pressure > records[replayWindowLen[buffer] - 1].pressure)){
+    return false;
+  }
+  return true;
+}
+
+
+
+/*************************************************************************/
+/*                            getReplaySample                            */
+/*                            ***************                            */
+/*                                                                       */
+/* parameters: pressure, a long in hundredths of a dbar                  */
+/*             temperature, salinity, oxygen, longs that the temperature,*/
+/*                  salinity (in ten thousandths) and oxygen (Hz) are    */
+/*                  written into, oxygen can be NULL                     */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function looks up a sample of the recorded profile. The window   */
+/* of the last sample is tried first, then the other buffer (the window  */
+/* the replay job read in ahead), and only if neither has it is the      */
+/* window read in now (a miss). The value is interpolated in a straight  */
+/* line between the two records around the pressure, past the ends of    */
+/* the profile it is the first or last record. Then the window after     */
+/* this one, in the direction the float is moving, is read in ahead by   */
+/* the replay job.                                                       */
+/*                                                                       */
+/*************************************************************************/
+
+void getReplaySample(long pressure, long *temperature, long *salinity, long *oxygen){
+  const ReplayRecord *records;
+  byte buffer = replayAt;
+  long window, next, part, span;
+  int low, high, middle;
+  
+  if(!replayCovers(buffer, pressure)){
+    buffer = 1 - buffer;
+    if(!replayCovers(buffer, pressure)){
+      window = findReplayWindow(pressure);
+      if(window == replayNext){
+        replayNext = -1;
+      }
+      replayMisses++;
+      if(!loadReplayWindow(buffer, window)){
+        *temperature = *salinity = 0;
+        if(oxygen != NULL){
+          *oxygen = 0;
+        }
+        return;
+      }
+    }
+  }
+  replayAt = buffer;
+  records = replayWindow[buffer];
+  
+  //the two records around the pressure
+  low = 0;
+  high = replayWindowLen[buffer] - 1;
+  while(high - low > 1){
+    middle = (low + high)/2;
+    if(records[middle].pressure <= pressure){
+      low = middle;
+    }
+    else{
+      high = middle;
+    }
+  }
+  if(pressure <= records[low].pressure){
+    high = low;
+  }
+  else if(pressure >= records[high].pressure){
+    low = high;
+  }
+  part = pressure - records[low].pressure;
+  span = records[high].pressure - records[low].pressure;
+  if(span <= 0){
+    part = span = 1;
+    low = high;
+  }
+  *temperature = records[low].temperature + (long long)(records[high].temperature - records[low].temperature)*part/span;
+  *salinity = records[low].salinity + (long long)(records[high].salinity - records[low].salinity)*part/span;
+  if(oxygen != NULL){
+    *oxygen = records[low].oxygen + (long long)(records[high].oxygen - records[low].oxygen)*part/span;
+  }
+  
+  //read the next window ahead, deeper while descending and shallower while ascending
+  next = replayWindowNo[buffer] + ((pressure >= replayPressure) ? 1 : -1);
+  replayPressure = pressure;
+  if((next >= 0)&&(next < replayWindows)&&(next != replayWindowNo[1 - buffer])&&(next != replayNext)){
+    replayNext = next;
+    startJob(JOB_REPLAY, 0);
+  }
+}
+
+
+
+/*************************************************************************/
+/*                        noiseRandom, noiseGauss                        */
+/*                        ***********************                        */
+/*                                                                       */
+/* parameters: sigma, a long that represents the standard deviation      */
+/*                                                                       */
+/* returns: the next random number (noiseRandom), a random number around */
+/*                  0 with about that standard deviation (noiseGauss)    */
+/*                                                                       */
+/* noiseRandom is a 32 bit xorshift, three shifts and xors with no       */
+/* multiply or divide, in uint32_t so it is the same on the Mega and on  */
+/* Linux. noiseGauss adds up the 4 bytes of one random number, which is  */
+/* close enough to a normal distribution for sensor noise, and scales it */
+/* to sigma.                                                             */
+/*                                                                       */
+/*************************************************************************/
+
+uint32_t noiseRandom(void){
+  noiseState ^= noiseState << 13;
+  noiseState ^= noiseState >> 17;
+  noiseState ^= noiseState << 5;
+  return noiseState;
+}
+
+long noiseGauss(long sigma){
+  uint32_t random = noiseRandom();
+  long sum = long(random & 0xFF) + long((random >> 8) & 0xFF) + long((random >> 16) & 0xFF) + long(random >> 24) - 510;
+  return sum*sigma/NOISESPREAD;
+}
+
+
+
+/*************************************************************************/
+/*                             addSensorNoise                            */
+/*                             **************                            */
+/*                                                                       */
+/* parameters: pressure, temperature, salinity, oxygen, longs of a sample*/
+/*                  the noise is added to, oxygen can be NULL            */
+/*                                                                       */
+/* returns: a boolean that is false if the sample dropped out            */
+/*                                                                       */
+/* This function adds the noise set with the noise commands to a sample: */
+/* noise of noiseSigma on each channel, then a spike (NOISESPIKEGAIN     */
+/* sigmas, up or down) on one channel in noiseSpike samples out of a     */
+/* thousand, and a dropout in noiseDropout out of a thousand. The same   */
+/* random numbers are drawn for every sample whatever it is (P, PT or    */
+/* PTS), so the run only depends on the seed and the samples asked for.  */
+/* Without noise it returns straight away.                               */
+/*                                                                       */
+/*************************************************************************/
+
+boolean addSensorNoise(long *pressure, long *temperature, long *salinity, long *oxygen){
+  long *values[NOISECHANNELS] = {pressure, temperature, salinity, oxygen};
+  uint32_t random;
+  long noise;
+  int i;
+  
+  if(!noiseOn){
+    return true;
+  }
+  for(i = 0; i < NOISECHANNELS; i++){
+    noise = noiseGauss(noiseSigma[i]);
+    if(values[i] != NULL){
+      *values[i] += noise;
+    }
+  }
+  
+  //the top 16 bits for the dropout, the bottom 16 for the spike, scaled to a thousand
+  random = noiseRandom();
+  if((((random >> 16)*1000UL) >> 16) < (unsigned long)noiseDropout){
+    noiseDropouts++;
+    return false;
+  }
+  if((((random & 0xFFFF)*1000UL) >> 16) < (unsigned long)noiseSpike){
+    random = noiseRandom();
+    i = random % NOISECHANNELS;
+    noise = NOISESPIKEGAIN*noiseSigma[i];
+    if(values[i] != NULL){
+      *values[i] += (random & 0x100) ? noise : -noise;
+    }
+    noiseSpikes++;
+  }
+  return true;
+}
+
+
+
+/*************************************************************************/
+/*                             getReadingFromPiston                      */
+/*                             ********************                      */
+/*                                                                       */
+/* parameters: select, an int value that represents which reading will   */
+/*                  be written (PTSO, PTS, PT, or P reading)             */
+/*             reply, a char buffer of REPLYSIZE that the reading is     */
+/*                  written into                                         */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function converts a reading from the analog input pin A0 to a    */
+/* string that represents P,T,S sample. This is achieved by manipulating */
+/* the input value and fitting it to generic, general values tested by   */
+/* Hugh Fargher. In general, we used 3 linear models to represent 3      */
+/* ranges of depth (2000m-1000m, 1000m-500m, 500m-0m) with different     */
+/* slopes and offsets. The temperature and salinity at that pressure are */
+/* looked up by getWaterSample, which handles any ice avoidance          */
+/* scenarios, then addSensorNoise adds any noise (the reply is left      */
+/* empty if the sample drops out). The values are in fixed point longs   */
+/* and written into the reply by readingToChars,                         */
+/* formatted to match a regex pattern expected by the APF board on the   */
+/* float. The select chooses which reading (PTSO, PTS, PT, or P) is      */
+/* written.                                                              */
+/*                                                                       */
+/*************************************************************************/
+
+void getReadingFromPiston(int select, char *reply){
+  //original calculated pressure as a float
+  float pressure;
+  
+  //represent the values as longs that are either 100 or 10000 times larger than the floats
+  long pressureLong;
+  long temperatureLong;
+  long salinityLong;
+  long oxygenLong = 0;
+  long *oxygen = (select == PTSO) ? &oxygenLong : NULL;
+  boolean dropped;
+  
+  //read an analog value on pin 1, use it for the calculations 1023=2.56V
+  int voltage = readPiston();
+  
+  //technically out of range, but use it to go to a pressure greater than 2000dbar, min change = 5dbar
+  if(voltage<72){
+    pressure = 2000+1*(voltage-72);
+  }
+  
+  //for pressures between 2000-1000dbar, 72 = 2000dbar, 293 = 1000dbar, min change = 4.5045dbar
+  else if((voltage>=72)&&(voltage<294)){
+    pressure = ((4.5045)*(222-(voltage-72)))+1000.00;
+  }
+  
+  //for pressures between 1000-500dbar, 294 = 1000dbar, 453 = 500dbar, min change = 3.125dbar
+  else if((voltage>=294)&&(voltage<454)){
+    pressure = ((3.125)*(160-(voltage-294)))+500.00;
+  }
+  
+  //for pressures between 500-0dbar, 454 = 500dbar, 1023 = 0dbar, min change = 0.878dbar
+  else{
+    pressure = ((0.878)*(569-(voltage-454)));
+  }
+  
+  //adjust for hardware that amplifies the signal by approximately 1.1 (PISTONGAIN)
+  pressure = pressure * PISTONGAIN;
+  
+  if(cpMode == 1){
+    if(pressure >= maxPress){
+      maxPress = pressure;
+    }
+    if(pressure <= minPress){
+      minPress = pressure;
+    }
+  }
+  
+  if(constant==1){
+    pressure = float(constantP);
+  }
+  
+  pressureLong = long(pressure*100);
+  
+  //look up the temperature and salinity (and oxygen for PTSO) at this pressure in the water
+  //column (with the ice overlay for the ice avoidance mode in effect)
+  getWaterSample(pressureLong, &temperatureLong, &salinityLong, oxygen);
+  
+  //the sensor noise, spikes and dropouts (noise), a sample that drops out isn't sent
+  dropped = !addSensorNoise(&pressureLong, &temperatureLong, &salinityLong, oxygen);
+  
+  if((cpMode==1)&&(pOrPTSsel==1)){
+    select=PTS;
+  }
+  else if((cpMode==1)&&(pOrPTSsel==0)){
+    select=P;
+  }
+  //keep the reading for continuous profiling to average
+  readingPressure = pressureLong;
+  readingTemperature = temperatureLong;
+  readingSalinity = salinityLong;
+  
+  //write the reading that was asked for (PTSO, PTS, PT, or P) into the reply, empty if it dropped out
+  if(dropped){
+    reply[0] = '\0';
+    return;
+  }
+  readingToChars(reply, select, pressureLong, temperatureLong, salinityLong, oxygenLong);
+}
+
+
+
+/*************************************************************************/
+/*                               getDynamicReading                       */
+/*                             ********************                      */
+/*                                                                       */
+/* parameters: select, an int value that represents which reading will   */
+/*                  be written (PTSO, PTS, PT, or P reading)             */
+/*             reply, a char buffer of REPLYSIZE that the reading is     */
+/*                  written into                                         */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function calculates a pressure based on the time it has spent in */
+/* a given phase during a mission and produce a string that represents   */
+/* a P; P,T; or P,T,S sample. The temperature and salinity at that       */
+/* pressure are looked up by getWaterSample, which handles any ice       */
+/* avoidance scenarios, then addSensorNoise adds any noise (the reply is */
+/* left empty if the sample drops out). The values are in fixed point    */
+/* longs and written into the reply by readingToChars,                   */
+/* formatted to match a regex pattern expected by the APF board on the   */
+/* float. The select chooses which reading (PTSO, PTS, PT, or P) is      */
+/* written.                                                              */
+/* The phase of the mission is determined by the global variable phase.  */
+/*                                                                       */
+/*************************************************************************/
+
+void getDynamicReading(int select, char *reply){
+  
+  updateTime();
+  
+  //the pressure as a float, for the deepest and shallowest of a profile
+  float pressure;
+  
+  //represent the values as longs that are either 100 or 10000 times larger than the floats
+  long pressureLong;
+  long temperatureLong;
+  long salinityLong;
+  long oxygenLong = 0;
+  long *oxygen = (select == PTSO) ? &oxygenLong : NULL;
+  boolean dropped;
+  
+  //the pressure at this point of the mission, from the schedule
+  pressureLong = missionPressure(missionTime);
+  
+  if(cpMode == 1){
+    pressure = pressureLong/100.0;
+    if(pressure >= maxPress){
+      maxPress = pressure;
+    }
+    if(pressure <= minPress){
+      minPress = pressure;
+    }
+  }
+  
+  if(constant == 1){
+    pressureLong = constantP*100L;
+  }
+  
+  //look up the temperature and salinity (and oxygen for PTSO) at this pressure in the water
+  //column (with the ice overlay for the ice avoidance mode in effect)
+  getWaterSample(pressureLong, &temperatureLong, &salinityLong, oxygen);
+  
+  //the sensor noise, spikes and dropouts (noise), a sample that drops out isn't sent
+  dropped = !addSensorNoise(&pressureLong, &temperatureLong, &salinityLong, oxygen);
+  
+  if((cpMode==1)&&(pOrPTSsel==1)){
+    select=PTS;
+  }
+  else if((cpMode==1)&&(pOrPTSsel==0)){
+    select=P;
+  } 
+ 
+  //keep the reading for continuous profiling to average
+  readingPressure = pressureLong;
+  readingTemperature = temperatureLong;
+  readingSalinity = salinityLong;
+  
+  //write the reading that was asked for (PTSO, PTS, PT, or P) into the reply, empty if it dropped out
+  if(dropped){
+    reply[0] = '\0';
+    return;
+  }
+  readingToChars(reply, select, pressureLong, temperatureLong, salinityLong, oxygenLong);
+}
+
+
+
+/*************************************************************************/
+/*                              binaverage                               */
+/*                              **********                               */
+/*                                                                       */
+/* parameters: reply, a char buffer of REPLYSIZE that the bin is written  */
+/*                  into                                                 */
+/*             encoder, the function that writes the bin in the format   */
+/*                  of the upload (binToAscii, binToHex or binToBinary)  */
+/*                                                                       */
+/* returns: an int that is the number of bytes of the bin to send        */
+/*                                                                       */
+/* This function will create the data requested by the binaverage        */
+/* command of the APFx. The function takes the next bin (inc) from the   */
+/* shallowest to the deepest, the average pressure, temperature and      */
+/* salinity of the samples addToBin put in it during continuous          */
+/* profiling and how many there were, and has the encoder write it into  */
+/* reply. If there are no samples in the bin, then all of the fields are */
+/* equal to 0. This function is meant to be called repeatedly when       */
+/* sending data to the APFx after receiving the 'da', 'dah' or 'dab'     */
+/* command, every format goes through here.                              */
+/*                                                                       */
+/*************************************************************************/
+
+int binaverage(char *reply, BinEncoder encoder){
+  
+  //fixed point values, pressure in hundredths, temperature and salinity in ten thousandths
+  long pressure = 0;
+  long temperature = 0;
+  long salinity = 0;
+  
+  int samplesUsed = 0;
+  
+  //the averages of the samples in the bin, if there are no samples all of the 
+  //values for that bin are zero
+  if((inc < MAXBINS)&&(bins[inc].samples > 0)){
+    samplesUsed = bins[inc].samples;
+    pressure = bins[inc].pressure/samplesUsed;
+    temperature = bins[inc].temperature/samplesUsed;
+    salinity = bins[inc].salinity/samplesUsed;
+  }
+  
+  //go on to the next bin
+  inc += 1;
+  
+  return encoder(reply, pressure, temperature, salinity, samplesUsed);
+}
+
+
+
+/*************************************************************************/
+/*                         binToAscii, binToHex                          */
+/*                         ********************                          */
+/*                                                                       */
+/* parameters: reply, a char buffer of REPLYSIZE that the bin is written  */
+/*                  into                                                 */
+/*             pressure, a long in hundredths of a dbar                  */
+/*             temperature, salinity, longs in ten thousandths           */
+/*             samplesUsed, an int that is the number of samples         */
+/*                                                                       */
+/* returns: an int that is the number of bytes of the bin to send,       */
+/*                  including the null at the end                        */
+/*                                                                       */
+/* These functions write a bin in the format expected by the APFx for    */
+/* the 'da' command (" pppp.pp, tt.tttt, ss.ssss, bb") or the 'dah'      */
+/* command ("ppppttttssssbb", in hex: pressure in tenths of a dbar,      */
+/* temperature and salinity in hundredths, each field a 16 bit two's     */
+/* complement value). An empty bin is all zeros.                         */
+/*                                                                       */
+/*************************************************************************/
+
+int binToAscii(char *reply, long pressure, long temperature, long salinity, int samplesUsed){
+  char *end = appendChars(reply, " ");
+  end = pressureToChars(end, pressure);
+  end = appendChars(end, ", ");
+  end = tempOrSalinityToChars(end, temperature);
+  end = appendChars(end, ", ");
+  end = tempOrSalinityToChars(end, salinity);
+  end = appendChars(end, ", ");
+  end = longToChars(end, samplesUsed);
+  end = appendChars(end, "\r\n");
+  return end - reply + 1;
+}
+
+int binToHex(char *reply, long pressure, long temperature, long salinity, int samplesUsed){
+  char *end;
+  if(samplesUsed!=0){
+    int pressureInt = pressure/10;
+    int temperatureInt = temperature/100;
+    int salinityInt = salinity/100;
+    end = hexToChars(reply, uint16_t(pressureInt), 4);
+    end = hexToChars(end, uint16_t(temperatureInt), 4);
+    end = hexToChars(end, uint16_t(salinityInt), 4);
+    end = hexToChars(end, samplesUsed, 2);
+    end = appendChars(end, "\n\r");
+  }
+  else{
+    end = appendChars(reply, "00000000000000\n\r");
+  }
+  return end - reply + 1;
+}
+
+
+
+/*************************************************************************/
+/*                              binToBinary                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: reply, a char buffer of REPLYSIZE that the bin is written  */
+/*                  into                                                 */
+/*             pressure, a long in hundredths of a dbar                  */
+/*             temperature, salinity, longs in ten thousandths           */
+/*             samplesUsed, an int that is the number of samples         */
+/*                                                                       */
+/* returns: an int that is the number of bytes of the bin to send        */
+/*                  (BINRECORDSIZE)                                      */
+/*                                                                       */
+/* This function writes a bin for the 'dab' command, the same fields as  */
+/* 'dah' as bytes instead of hex digits: pressure, temperature and       */
+/* salinity as 16 bit two's complement values (most significant byte     */
+/* first) then the number of samples, 7 bytes instead of 16. An empty    */
+/* bin is all zeros.                                                     */
+/*                                                                       */
+/*************************************************************************/
+
+int binToBinary(char *reply, long pressure, long temperature, long salinity, int samplesUsed){
+  uint16_t pressureInt = int(pressure/10);
+  uint16_t temperatureInt = int(temperature/100);
+  uint16_t salinityInt = int(salinity/100);
+  reply[0] = pressureInt >> 8;
+  reply[1] = pressureInt & 0xFF;
+  reply[2] = temperatureInt >> 8;
+  reply[3] = temperatureInt & 0xFF;
+  reply[4] = salinityInt >> 8;
+  reply[5] = salinityInt & 0xFF;
+  reply[6] = samplesUsed;
+  return BINRECORDSIZE;
+}
+
+
+
+/*************************************************************************/
+/*                             oxygenPumpTime                            */
+/*                             **************                            */
+/*                                                                       */
+/* parameters: pressure, a long in hundredths of a dbar                  */
+/*             temperature, a long in ten thousandths of a degree C      */
+/*                                                                       */
+/* returns: an unsigned long that represents how long (ms) the SBE43F    */
+/*          pumps before an oxygen sample at the pressure and temperature*/
+/*                                                                       */
+/* This function works out the pump time the way Sbe43PumpTime in        */
+/* sbe41.c does, so a PTSO sample takes as long as the APFx expects. The */
+/* time constant of the sensor (TAU_20) is corrected for the pressure    */
+/* and temperature (a p or t the driver wouldn't trust is replaced the   */
+/* way it does), kept to 2-30 sec, and the pump runs for Nf+Ns of them,  */
+/* 7-100 sec. Only called for a PTSO sample, so the float math isn't in  */
+/* the way of anything else.                                             */
+/*                                                                       */
+/*************************************************************************/
+
+unsigned long oxygenPumpTime(long pressure, long temperature){
+  float p = pressure/100.0;
+  float t = temperature/10000.0;
+  float tau;
+  long pump;
+  
+  if((t < -2)||(t > 40)){
+    t = 4;
+  }
+  if((p < 0)||(p > 2500)){
+    p = 2000;
+  }
+  tau = (OXYGENTAU20/100.0)*exp(OXYGENPCOR*p)*exp(OXYGENTCOR*(t - 20));
+  if(tau < OXYGENTAUMIN){
+    tau = OXYGENTAUMIN;
+  }
+  else if(tau > OXYGENTAUMAX){
+    tau = OXYGENTAUMAX;
+  }
+  pump = long((oxygenNf + oxygenNs)*tau/10 + 0.5);
+  if(pump < OXYGENPUMPMIN){
+    pump = OXYGENPUMPMIN;
+  }
+  else if(pump > OXYGENPUMPMAX){
+    pump = OXYGENPUMPMAX;
+  }
+  return pump*1000UL;
+}
+
+
+
+/*************************************************************************/
+/*                            startOxygenPump                            */
+/*                            ***************                            */
+/*                                                                       */
+/* parameters: reply, the PTSO sample, empty if it dropped out           */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function keeps the PTSO sample and starts the pump: the oxygen   */
+/* job sends the sample once the pump time of the reading (the p,t kept  */
+/* by getReadingFromPiston or getDynamicReading) is up. The pump times   */
+/* are added up for the oxygen command, the wall clock and energy a PTSO */
+/* sample costs the APFx.                                                */
+/*                                                                       */
+/*************************************************************************/
+
+void startOxygenPump(const char *reply){
+  strcpy(oxygenReply, reply);
+  oxygenPump = oxygenPumpTime(readingPressure, readingTemperature);
+  oxygenPumpTotal += oxygenPump;
+  oxygenSamples++;
+  startJob(JOB_OXYGEN, oxygenPump);
+}
+
+
+
+/*************************************************************************/
+/*                             readingToChars                            */
+/*                             **************                            */
+/*                                                                       */
+/* parameters: buf, the char buffer the reading is written into          */
+/*             select, an int value that represents which reading is     */
+/*                  written (PTSO, PTS, PT, or P)                        */
+/*             pressure, a long in hundredths of a dbar                  */
+/*             temperature, salinity, longs in ten thousandths           */
+/*             oxygen, a long in Hz                                      */
+/*                                                                       */
+/* returns: a pointer to the null at the end of the reading              */
+/*                                                                       */
+/* This function writes a reading in the format expected by the APFx,    */
+/* "pppp.pp, tt.tttt, ss.ssss, oooo" followed by a carriage return and   */
+/* line feed, leaving out oxygen for a PTS reading, salinity too for a   */
+/* PT reading and temperature too for a P reading.                       */
+/*                                                                       */
+/*************************************************************************/
+
+char *readingToChars(char *buf, int select, long pressure, long temperature, long salinity, long oxygen){
+  buf = pressureToChars(buf, pressure);
+  if((select == PTSO)||(select == PTS)||(select == PT)){
+    buf = appendChars(buf, ", ");
+    buf = tempOrSalinityToChars(buf, temperature);
+  }
+  if((select == PTSO)||(select == PTS)){
+    buf = appendChars(buf, ", ");
+    buf = tempOrSalinityToChars(buf, salinity);
+  }
+  
+  //the frequency is a whole number of up to 5 digits
+  if(select == PTSO){
+    buf = appendChars(buf, ", ");
+    if(oxygen < 0){
+      oxygen = 0;
+    }
+    else if(oxygen > 99999){
+      oxygen = 99999;
+    }
+    buf = longToChars(buf, oxygen);
+  }
+  return appendChars(buf, "\r\n");
+}
+
+
+
+/*************************************************************************/
+/*                            pressureToChars                            */
+/*                            ***************                            */
+/*                                                                       */
+/* parameters: buf, the char buffer the pressure is written into         */
+/*             pressure, a long in hundredths of a dbar                  */
+/*                                                                       */
+/* returns: a pointer to the null at the end of the pressure             */
+/*                                                                       */
+/* This function writes a fixed point pressure with the formatting for   */
+/* a pressure value (" pppp.pp") by splitting it into its whole and      */
+/* decimal parts. Only integer math, nothing is allocated.               */
+/*                                                                       */
+/*************************************************************************/
+
+char *pressureToChars(char *buf, long pressure){
+  buf = appendChars(buf, " ");
+  if(pressure < 0){
+    buf = appendChars(buf, "-");
+    pressure = -pressure;
+  }
+  buf = longToChars(buf, pressure/100);
+  buf = appendChars(buf, ".");
+  
+  //always 2 decimal places (i.e. get .09 instead of .9)
+  return digitsToChars(buf, pressure%100, 2);
+}
+
+
+
+/*************************************************************************/
+/*                         tempOrSalinityToChars                         */
+/*                         *********************                         */
+/*                                                                       */
+/* parameters: buf, the char buffer the value is written into            */
+/*             value, a long in ten thousandths of a degree or psu       */
+/*                                                                       */
+/* returns: a pointer to the null at the end of the value                */
+/*                                                                       */
+/* This function writes a fixed point temperature or salinity with the   */
+/* formatting for a temperature or salinity value (" tt.tttt") by        */
+/* splitting it into its whole and decimal parts. Only integer math,     */
+/* nothing is allocated.                                                 */
+/*                                                                       */
+/*************************************************************************/
+
+char *tempOrSalinityToChars(char *buf, long value){
+  buf = appendChars(buf, " ");
+  if(value < 0){
+    buf = appendChars(buf, "-");
+    value = -value;
+  }
+  buf = longToChars(buf, value/10000);
+  buf = appendChars(buf, ".");
+  
+  //always 4 decimal places (i.e. get .0009 instead of .9)
+  return digitsToChars(buf, value%10000, 4);
+}
+
+
+
+/*************************************************************************/
+/*                              longToChars                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: buf, the char buffer the number is written into           */
+/*             value, the long to be written                             */
+/*                                                                       */
+/* returns: a pointer to the null at the end of the number               */
+/*                                                                       */
+/* This function writes a long in decimal, with a minus sign if it is    */
+/* negative and without leading zeros.                                   */
+/*                                                                       */
+/*************************************************************************/
+
+char *longToChars(char *buf, long value){
+  unsigned long magnitude = value;
+  unsigned long rest;
+  byte digits = 1;
+  
+  if(value < 0){
+    buf = appendChars(buf, "-");
+    magnitude = -value;
+  }
+  for(rest = magnitude; rest >= 10; rest /= 10){
+    digits++;
+  }
+  return digitsToChars(buf, magnitude, digits);
+}
+
+
+
+/*************************************************************************/
+/*                            longLongToChars                            */
+/*                            ***************                            */
+/*                                                                       */
+/* parameters: buf, the char buffer the number is written into           */
+/*             value, the long long to be written                        */
+/*                                                                       */
+/* returns: a pointer to the null at the end of the number               */
+/*                                                                       */
+/* This function writes a long long the way longToChars writes a long,   */
+/* nine digits at a time so the digits are worked out in unsigned longs. */
+/*                                                                       */
+/*************************************************************************/
+
+char *longLongToChars(char *buf, long long value){
+  unsigned long long magnitude = value;
+  
+  if(value < 0){
+    buf = appendChars(buf, "-");
+    magnitude = -value;
+  }
+  if(magnitude < 1000000000ULL){
+    return longToChars(buf, long(magnitude));
+  }
+  buf = longLongToChars(buf, magnitude/1000000000ULL);
+  return digitsToChars(buf, magnitude%1000000000ULL, 9);
+}
+
+
+
+/*************************************************************************/
+/*                             digitsToChars                             */
+/*                             *************                             */
+/*                                                                       */
+/* parameters: buf, the char buffer the digits are written into          */
+/*             value, the number to be written                           */
+/*             digits, how many decimal digits to write                  */
+/*                                                                       */
+/* returns: a pointer to the null at the end of the digits               */
+/*                                                                       */
+/* This function writes the last digits decimal digits of value, padded  */
+/* with leading zeros.                                                   */
+/*                                                                       */
+/*************************************************************************/
+
+char *digitsToChars(char *buf, unsigned long value, byte digits){
+  char *end = buf + digits;
+  
+  *end = '\0';
+  while(end > buf){
+    *--end = '0' + value%10;
+    value /= 10;
+  }
+  return buf + digits;
+}
+
+
+
+/*************************************************************************/
+/*                               hexToChars                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: buf, the char buffer the digits are written into          */
+/*             value, the number to be written                           */
+/*             digits, the least number of hex digits to write           */
+/*                                                                       */
+/* returns: a pointer to the null at the end of the digits               */
+/*                                                                       */
+/* This function writes value in upper case hex, padded with leading     */
+/* zeros to at least the given number of digits.                         */
+/*                                                                       */
+/*************************************************************************/
+
+char *hexToChars(char *buf, unsigned long value, byte digits){
+  unsigned long rest;
+  byte needed = 1;
+  char *end;
+  
+  for(rest = value; rest >= 16; rest /= 16){
+    needed++;
+  }
+  if(needed > digits){
+    digits = needed;
+  }
+  end = buf + digits;
+  *end = '\0';
+  while(end > buf){
+    *--end = "0123456789ABCDEF"[value%16];
+    value /= 16;
+  }
+  return buf + digits;
+}
+
+
+
+/*************************************************************************/
+/*                              appendChars                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: buf, the char buffer the text is written into             */
+/*             text, the text to be written                              */
+/*                                                                       */
+/* returns: a pointer to the null at the end of the text                 */
+/*                                                                       */
+/* This function copies text to buf, it is used to put a reply together  */
+/* piece by piece without allocating anything.                           */
+/*                                                                       */
+/*************************************************************************/
+
+char *appendChars(char *buf, const char *text){
+  while(*text){
+    *buf++ = *text++;
+  }
+  *buf = '\0';
+  return buf;
+}
+
+
+
+/*************************************************************************/
+/*                              missionClock                             */
+/*                              ************                             */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: an unsigned long long that represents the mission clock (ms) */
+/*                                                                       */
+/* This function is the clock the mission time is kept by (updateTime    */
+/* and lastUpdate), it runs timeScale times faster than clockMillis()    */
+/* and not at all while the mission is paused. It adds how far          */
+/* clockMillis() moved on since the last read, so it doesn't wrap with   */
+/* it (every 49.7 days) as long as it is read more often than that (the  */
+/* phase job). The Serial1 timing (replies, line requests, continuous   */
+/* profiling samples) uses clockMillis() and stays real time.            */
+/*                                                                       */
+/*************************************************************************/
+
+unsigned long long missionClock(void){
+  unsigned long now = clockMillis();
+  if(!clockPaused){
+    clockTotal += (unsigned long long)(now - clockLast)*timeScale;
+  }
+  clockLast = now;
+  return clockTotal;
+}
+
+
+
+/*************************************************************************/
+/*                           pauseMissionClock                           */
+/*                           *****************                           */
+/*                                                                       */
+/* parameters: paused, a boolean that represents whether the mission     */
+/*                  clock stops (true) or runs again (false)             */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function stops or restarts the mission clock. The time up to now */
+/* is counted first, so the mission carries on from where it was paused  */
+/* and none of the mission parameters change.                            */
+/*                                                                       */
+/*************************************************************************/
+
+void pauseMissionClock(boolean paused){
+  missionClock();
+  clockPaused = paused;
+}
+
+
+
+/*************************************************************************/
+/*                              setTimeScale                             */
+/*                              ************                             */
+/*                                                                       */
+/* parameters: scale, a long that represents how many times faster than  */
+/*                  real time the mission clock runs                     */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function changes the speed of the mission clock from now on,     */
+/* without a jump in the mission time. The piston and phase jobs run     */
+/* that much more often (from now) so they keep up with the mission.     */
+/*                                                                       */
+/*************************************************************************/
+
+void setTimeScale(long scale){
+  missionClock();
+  timeScale = scale;
+  jobs[JOB_PISTON].period = 15000/scale;
+  jobs[JOB_PHASE].period = 1000/scale;
+  if(jobs[JOB_PISTON].period == 0){
+    jobs[JOB_PISTON].period = 1;
+  }
+  if(jobs[JOB_PHASE].period == 0){
+    jobs[JOB_PHASE].period = 1;
+  }
+  startJob(JOB_PISTON, jobs[JOB_PISTON].period);
+  startJob(JOB_PHASE, jobs[JOB_PHASE].period);
+}
+
+
+
+/*************************************************************************/
+/*                               updateTime                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: a long long value that represents the mission time (ms) in   */
+/*                 the mission                                           */
+/*                                                                       */
+/* This function updates the mission time of the mission and determines  */
+/* which part of the mission the simulator should be in, currently, the  */
+/* default order is prelude, park descent, park, deep descent, ascent,   */
+/* surface mode, then repeat                                             */
+/*                                                                       */
+/*************************************************************************/
+
+long long updateTime(void){
+  
+  //update the last phase
+  lastPhase = currentPhase;
+  
+  //only update time while in a mission
+  if(HAS_MISSION && (missionMode >= 100)){
+    
+    //if surface mode, don't update time either
+    if(currentPhase == SURFACE){
+      if(missionTime <  (downTime + ascentTime)){
+        currentPhase = PRELUDE;
+      } 
+    }
+    
+    //in any other part of the mission
+    else{
+      
+      update = missionClock();
+      
+      //update the mission time by adding the update interval, the mission clock
+      //doesn't overflow, and the display (seconds) from it so no part of a second is lost
+      missionTime += (long long)(update - lastUpdate);
+      missionTimeDisplay = long(missionTime/1000);
+      
+      //set the value of lastUpdate to now
+      lastUpdate = update;
+      
+      //the phase the mission time is in, from the schedule
+      currentPhase = schedule[missionStep(missionTime)].phase;
+    }
+  }
+  if(lastPhase!=currentPhase){
+    trace(TRACE_PHASE, (lastPhase << 8) | currentPhase);
+  }
+  return missionTime;
+}
+
+
+
+/*************************************************************************/
+/*                             setAscentTimes                            */
+/*                             **************                            */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function works out how long the ascent takes at ascentRate from  */
+/* the deep profile pressure (ascentTime) and splits it at the park      */
+/* pressure into the ascent to park and the ascent to the surface. It is */
+/* run whenever one of them changes, so they always agree.               */
+/*                                                                       */
+/*************************************************************************/
+
+void setAscentTimes(void){
+  if((ascentRate <= 0)||(deepProfilePressure <= 0)){
+    return;
+  }
+  ascentTime = deepProfilePressure*100000L/ascentRate;
+  ascentTimeCopy = ascentTime;
+  ascentToSurface = (long long)ascentTime*parkPressure/deepProfilePressure;
+  ascentToSurfaceCopy = ascentToSurface;
+  ascentToPark = ascentTime - ascentToSurface;
+  ascentToParkCopy = ascentToPark;
+}
+
+
+
+/*************************************************************************/
+/*                          buildMissionSchedule                         */
+/*                          ********************                         */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function works out the schedule of the mission from its          */
+/* parameters: when each phase starts and the pressure during it as a    */
+/* straight line over the mission time. It is run whenever a mission     */
+/* parameter changes (the commands, the piston checks and the ice modes, */
+/* which start the park descent at the ice pressure), so updateTime and  */
+/* the readings only have to look the time up in it. A phase starts the  */
+/* millisecond after the time it is worked out from, i*t has always      */
+/* compared the times that way.                                          */
+/*                                                                       */
+/*        prelude: 0 until the mission time is past 0                    */
+/*        park descent: to the park pressure over parkDescentTime        */
+/*        park: the park pressure until the deep descent                 */
+/*        deep descent: to the deep profile pressure, ends at downTime   */
+/*        ascent to park: to the park pressure over ascentToPark         */
+/*        ascent to surface: to 0 over ascentToSurface                   */
+/*        surface: 0 once past downTime + ascentTime                     */
+/*                                                                       */
+/*************************************************************************/
+
+void buildMissionSchedule(void){
+  long park = parkPressure*100L;
+  long deep = deepProfilePressure*100L;
+  long offset = 0;
+  long long deepStart = downTime - deepProfileDescentTime;
+  long long ascentMiddle = downTime + ascentToPark;
+  
+  //ice detect and ice cap start the park descent from the ice pressure
+  if((iceAvoidance == ICEDETECT)||(iceAvoidance == ICECAP)){
+    offset = icePressure*100L;
+  }
+  
+  setMissionStep(0, PRELUDE, -9223372036854775807LL-1, 0, 0, 0, 0);
+  setMissionStep(1, PARKDESCENT, 1, offset, offset + park, 0, parkDescentTime);
+  setMissionStep(2, PARK, parkDescentTime + 1, park, park, 0, 0);
+  setMissionStep(3, DEEPDESCENT, deepStart + 1, park, deep, deepStart, deepProfileDescentTime);
+  setMissionStep(4, ASCENTTOPARK, downTime + 1, deep, park, downTime, ascentToPark);
+  setMissionStep(5, ASCENTTOSURFACE, ascentMiddle + 1, park, 0, ascentMiddle, ascentToSurface);
+  setMissionStep(6, SURFACE, downTime + ascentTime + 1, 0, 0, 0, 0);
+}
+
+
+
+/*************************************************************************/
+/*                             setMissionStep                            */
+/*                             **************                            */
+/*                                                                       */
+/* parameters: step, an int that is the step of the schedule             */
+/*             phase, a byte that is the phase of the step               */
+/*             start, a long long that is the mission time (ms) it       */
+/*                  starts at                                            */
+/*             from, to, longs that are the pressure (hundredths of a    */
+/*                  dbar) the phase goes from and to                     */
+/*             origin, a long long that is the mission time (ms) the     */
+/*                  pressure is from at                                  */
+/*             duration, a long that is how long (ms) it takes to get to */
+/*                  to (0: the pressure stays at from)                   */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* A step never starts before the one before it, a phase whose start is  */
+/* earlier than the one of the phase before is skipped over at the time  */
+/* the phase before starts, the same as the mission has always done.     */
+/*                                                                       */
+/*************************************************************************/
+
+void setMissionStep(int step, byte phase, long long start, long from, long to, long long origin, long duration){
+  long long slope = 0;
+  
+  if((step > 0)&&(start < schedule[step-1].start)){
+    start = schedule[step-1].start;
+  }
+  if(duration > 0){
+    slope = (long long)(to - from)*(1LL << SCHEDULESHIFT)/duration;
+  }
+  schedule[step].phase = phase;
+  schedule[step].start = start;
+  schedule[step].origin = origin;
+  schedule[step].pressure = from;
+  schedule[step].slope = slope;
+}
+
+
+
+/*************************************************************************/
+/*                        missionStep, missionPressure                   */
+/*                        ****************************                   */
+/*                                                                       */
+/* parameters: time, a long long that is a mission time (ms)             */
+/*                                                                       */
+/* returns: the step of the schedule the time is in (missionStep), the   */
+/*                  pressure (hundredths of a dbar) at the time          */
+/*                  (missionPressure)                                    */
+/*                                                                       */
+/* The lookup starts from the step the last one found (scheduleAt), the  */
+/* mission time mostly stays in the same phase or goes on to the next,   */
+/* so it is a compare or two. The pressure is the pressure of the step   */
+/* at its origin plus the slope times the time since then.               */
+/*                                                                       */
+/*************************************************************************/
+
+int missionStep(long long time){
+  while((scheduleAt + 1 < MISSIONSTEPS)&&(time >= schedule[scheduleAt + 1].start)){
+    scheduleAt++;
+  }
+  while((scheduleAt > 0)&&(time < schedule[scheduleAt].start)){
+    scheduleAt--;
+  }
+  return scheduleAt;
+}
+
+long missionPressure(long long time){
+  MissionStep *step = &schedule[missionStep(time)];
+  return step->pressure + long((step->slope*(time - step->origin)) >> SCHEDULESHIFT);
+}
+
+
+
+/*************************************************************************/
+/*                               writeBytes                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: aString, a string value to be written over Serial1 as a   */
+/*                 series of bytes                                       */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function sends the string over Serial1 as a series of bytes,     */
+/* including the null at the end of the string. The string can be a      */
+/* String or a char buffer (the reply buffers are written by the         */
+/* ...ToChars functions). The bytes are put in txBuffer and sent from    */
+/* there by serviceTx, so this returns as soon as the reply is queued.   */
+/* Only a reply that doesn't fit in the room left has to wait, and then  */
+/* just until enough of txBuffer has been sent for the rest of it.       */
+/*                                                                       */
+/*************************************************************************/      
+void writeBytes(String aString){
+  writeBytes(aString.c_str());
+}
+
+void writeBytes(const char *aString){
+  int len = strlen(aString)+1;
+  queueBytes((const byte *)aString, len);
+  trace(TRACE_TX, len);
+}
+
+
+
+/*************************************************************************/
+/*                               writeFlash                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: text, a string in flash (PROGMEM) to be written over      */
+/*                 Serial1 as a series of bytes                          */
+/*             numbers, the values of the FIELDNUMBER fields of text     */
+/*             texts, the strings of the FIELDTEXT fields of text        */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function sends the text like writeBytes (with the null at the    */
+/* end), but as an upload: the values of the fields are copied (they     */
+/* can be on the stack of the command) and flashToRecord reads the text  */
+/* from flash a record at a time as txBuffer has room for it, so the     */
+/* reply takes no SRAM and nothing waits for it however long it is.      */
+/*                                                                       */
+/*************************************************************************/
+
+void writeFlash(const char *text, const long *numbers, const char *const *texts){
+  char *copy = uploadTexts;
+  const char *next = text;
+  int field = 0;
+  char c;
+  
+  while((c = pgm_read_byte(next++)) != '\0'){
+    if((c == FIELDNUMBER[0])&&(field < UPLOADNUMBERS)){
+      uploadNumbers[field++] = *numbers++;
+    }
+    else if(c == FIELDTEXT[0]){
+      if(copy + strlen(*texts) < uploadTexts + UPLOADTEXTSIZE){
+        copy = appendChars(copy, *texts) + 1;
+      }
+      texts++;
+    }
+  }
+  startUpload(UPLOAD_FLASH);
+  uploadFlash = text;
+  uploadText = uploadTexts;
+}
+
+
+
+/*************************************************************************/
+/*                               queueBytes                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: data, the bytes to be sent over Serial1                   */
+/*             len, an int that is the number of bytes in data           */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function puts the bytes in txBuffer, waiting (sending from       */
+/* txBuffer) only for as much room as the bytes that don't fit need.     */
+/* The replies that are longer than txBuffer are uploads instead, so it  */
+/* only waits if short replies pile up faster than they are sent.        */
+/*                                                                       */
+/*************************************************************************/
+
+void queueBytes(const byte *data, int len){
+  int sent;
+  while(len > 0){
+    sent = txWrite(data, len);
+    data += sent;
+    len -= sent;
+    serviceTx();
+  }
+}
+
+
+
+/*************************************************************************/
+/*                                txSpace                                */
+/*                                *******                                */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: an int that is the number of bytes that can be put in        */
+/*                  txBuffer right now                                   */
+/*                                                                       */
+/*************************************************************************/
+
+int txSpace(void){
+  return (txTail + TXBUFFERSIZE - txHead - 1) % TXBUFFERSIZE;
+}
+
+
+
+/*************************************************************************/
+/*                                txWrite                                */
+/*                                *******                                */
+/*                                                                       */
+/* parameters: data, the bytes to be sent over Serial1                   */
+/*             len, an int that is the number of bytes in data           */
+/*                                                                       */
+/* returns: an int that is the number of bytes put in txBuffer, less     */
+/*                  than len if there wasn't room for all of them        */
+/*                                                                       */
+/* This function never waits. The caller keeps the bytes that didn't     */
+/* fit and tries them again later (check txSpace first to only queue a   */
+/* whole record).                                                        */
+/*                                                                       */
+/*************************************************************************/
+
+int txWrite(const byte *data, int len){
+  int i;
+  int room = txSpace();
+  if(len > room){
+    len = room;
+  }
+  for(i = 0; i < len; i++){
+    txBuffer[txHead] = data[i];
+    txHead = (txHead + 1) % TXBUFFERSIZE;
+  }
+  statsBytes += len;
+  return len;
+}
+
+
+
+/*************************************************************************/
+/*                               serviceTx                               */
+/*                               *********                               */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Called every time through the loop. This function moves as many      */
+/* bytes from txBuffer to Serial1 as fit in its transmit buffer without  */
+/* waiting, the Serial1 interrupt sends them from there while the loop   */
+/* goes on with the hardware lines, the piston and continuous profiling. */
+/* The time the first byte of a reply goes is its latency (stats).       */
+/*                                                                       */
+/*************************************************************************/
+
+void serviceTx(void){
+  int room = ctdAvailableForWrite();
+  if(statsWaiting&&(room > 0)&&(txTail != txHead)){
+    statsFirst = clockMicros();
+    statsWaiting = false;
+  }
+  while((room > 0)&&(txTail != txHead)){
+    ctdWrite(txBuffer[txTail]);
+    txTail = (txTail + 1) % TXBUFFERSIZE;
+    room--;
+  }
+}
+
+
+
+/*************************************************************************/
+/*                               validBaud                               */
+/*                               *********                               */
+/*                                                                       */
+/* parameters: rate, a long that is a baud rate                          */
+/*                                                                       */
+/* returns: a boolean that is true if Serial1 can run at the rate        */
+/*                                                                       */
+/*************************************************************************/
+
+boolean validBaud(long rate){
+  switch(rate){
+    case 9600:
+    case 19200:
+    case 38400:
+    case 57600:
+    case 115200:
+      return true;
+  }
+  return false;
+}
+
+
+
+/*************************************************************************/
+/*                              startSerial1                             */
+/*                              ************                             */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function starts Serial1 at the baud rate kept in the EEPROM. A   */
+/* rate other than 9600 has to be confirmed the same as after a baud=    */
+/* command, so a float that only talks at 9600 still gets through. A     */
+/* blank (or bad) EEPROM means 9600.                                     */
+/*                                                                       */
+/*************************************************************************/
+
+void startSerial1(void){
+  long rate;
+  EEPROM.get(BAUDADDRESS, rate);
+  baudRate = BAUDDEFAULT;
+  baudState = BAUD_SET;
+  if(validBaud(rate)&&(rate != BAUDDEFAULT)){
+    baudRate = rate;
+    baudState = BAUD_CONFIRM;
+    baudSince = clockMillis();
+  }
+  ctdBegin(baudRate);
+}
+
+
+
+/*************************************************************************/
+/*                              serviceBaud                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Called every time through the loop. After a baud= command, this       */
+/* function waits for the reply to be sent at the old rate then changes  */
+/* Serial1 to the new one. If no command comes in at the new rate within */
+/* BAUDTIMEOUT ms, Serial1 goes back to 9600 and the rate given up on    */
+/* is recorded in the trace.                                             */
+/*                                                                       */
+/*************************************************************************/
+
+void serviceBaud(void){
+  if(baudState == BAUD_SWITCH){
+    if(txTail != txHead){
+      return;
+    }
+    ctdFlush();
+    baudRate = baudNext;
+    ctdBegin(baudRate);
+    baudSince = clockMillis();
+    baudState = BAUD_CONFIRM;
+    
+    //9600 needs no confirming, keep it
+    if(baudRate == BAUDDEFAULT){
+      baudState = BAUD_SET;
+      EEPROM.put(BAUDADDRESS, baudRate);
+    }
+  }
+  else if(baudState == BAUD_CONFIRM){
+    if(clockMillis() - baudSince > BAUDTIMEOUT){
+      trace(TRACE_BAUD, baudRate/100);
+      baudRate = BAUDDEFAULT;
+      ctdBegin(baudRate);
+      baudState = BAUD_SET;
+    }
+  }
+}
+
+
+
+/*************************************************************************/
+/*                           startJob, stopJob                           */
+/*                           *****************                           */
+/*                                                                       */
+/* parameters: job, an int that represents the job (JOB_PISTON,          */
+/*                  JOB_PHASE, JOB_SERNO, JOB_REPLAY, JOB_STORE,         */
+/*                  JOB_OXYGEN, JOB_REPLY, JOB_CP or JOB_PROFILESTART)   */
+/*             first, an unsigned long that represents how long (ms)     */
+/*                  from now the job first runs                          */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* These functions start a job of the scheduler (again from now if it    */
+/* was already started) and stop it. A job the variant doesn't have (cp  */
+/* and profilestart without HAS_CP) is not in the table and is ignored.  */
+/*                                                                       */
+/*************************************************************************/
+
+void startJob(int job, unsigned long first){
+  if(job >= NJOBS){
+    return;
+  }
+  jobs[job].next = clockMillis() + first;
+  jobs[job].active = true;
+}
+
+void stopJob(int job){
+  if(job >= NJOBS){
+    return;
+  }
+  jobs[job].active = false;
+}
+
+
+
+/*************************************************************************/
+/*                                runJobs                                */
+/*                                *******                                */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Called every time through the loop. This function runs each job that  */
+/* is due. The next time a job is due is moved on by its period from     */
+/* when it was due, not from now, so the jobs don't drift. If the loop   */
+/* was busy for longer than a period, the job runs once and the runs it  */
+/* missed are counted as overruns instead of being run back to back.     */
+/* A job with a period of 0 is stopped after it runs.                    */
+/*                                                                       */
+/*************************************************************************/
+
+void runJobs(void){
+  int i;
+  unsigned long now;
+  unsigned long late;
+  unsigned long missed;
+  
+  for(i = 0; i < NJOBS; i++){
+    if(!jobs[i].active){
+      continue;
+    }
+    now = clockMillis();
+    
+    //not due yet (works through the clock rolling over)
+    if(long(now - jobs[i].next) < 0){
+      continue;
+    }
+    late = now - jobs[i].next;
+    if(late > jobs[i].lateMax){
+      jobs[i].lateMax = late;
+    }
+    jobs[i].runs++;
+    
+    //a job that runs once
+    if(jobs[i].period == 0){
+      jobs[i].active = false;
+    }
+    
+    //when it is due next, skipping the runs that were missed
+    else{
+      jobs[i].next += jobs[i].period;
+      if(late >= jobs[i].period){
+        missed = late/jobs[i].period;
+        jobs[i].overruns += missed;
+        jobs[i].next += missed*jobs[i].period;
+      }
+    }
+    jobs[i].run();
+  }
+}
+
+
+
+/*************************************************************************/
+/*                                 cpJob                                 */
+/*                                 *****                                 */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Runs once a second while in continuous profiling mode. Performs all   */
+/* functions associated with continuous profiling (getting reading every */
+/* second based on real-time output and comparing it to p cut off), the  */
+/* job stops once the profile has stopped, and the samples recorded to   */
+/* the SD card are written out. If the profile stopped during an upload, */
+/* the job first runs again each ms until it can send "profile stopped". */
+/*                                                                       */
+/*************************************************************************/
+
+void cpJob(void){
+  if(cpStopReply){
+    if(uploadType != UPLOAD_NONE){
+      startJob(JOB_CP, 1);
+      return;
+    }
+    String exitcp = "profile stopped";
+    writeBytes(exitcp);
+    cpStopReply = false;
+  }
+  if(cpMode != 1){
+    stopJob(JOB_CP);
+    storeSync = true;
+    return;
+  }
+  continuousProfile();
+}
+
+
+
+/*************************************************************************/
+/*                               pistonJob                               */
+/*                               *********                               */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Runs every 15 seconds. Checks the piston position for the phase of    */
+/* the mission (or the prelude), which can change the phase.             */
+/*                                                                       */
+/*************************************************************************/
+
+void pistonJob(void){
+  //if the simulator is running a mission
+  if(HAS_MISSION && (missionMode >= 100)){
+    
+    //handle the piston position changing
+    switch(currentPhase){
+      
+      case SURFACE:
+        checkPistonSurface();
+        break;
+        
+      //handle the float descending for a short park or leaving park earlier than anticipated
+      //by checking the piston position every 15 sceonds, this will start 2min into park
+      case PARK:
+        if(missionTime>(parkDescentTime+120000)){
+          checkPistonPark();
+        }
+        break;
+      
+      //handle the float detecting ice by checking the piston position every 15 seconds during the ascent
+      //once the pressure is less than 60dbar
+      case ASCENTTOSURFACE:
+        if(missionPressure(missionTime) < 6000){
+          checkPistonAscent();
+        }
+        break;
+    }
+  }
+  else{
+    
+    //handle the float descending at any point during the designated prelude time by checking
+    //for a decreasing piston position every 15 seconds, this will start 15min into prelude
+    if(HAS_MISSION && (prelude == 1)){
+      checkPistonPrelude();
+    }
+  }
+}
+
+
+
+/*************************************************************************/
+/*                               phaseJob                                */
+/*                               ********                                */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Runs once a second. Keeps the mission time and phase up to date while */
+/* the simulator is running a mission, not just when a reading or a      */
+/* command needs them.                                                   */
+/*                                                                       */
+/*************************************************************************/
+
+void phaseJob(void){
+  if(HAS_MISSION && (missionMode >= 100)){
+    updateTime();
+  }
+  else{
+    missionClock();
+  }
+}
+
+
+
+/*************************************************************************/
+/*                       sernoJob, profileStartJob                       */
+/*                       *************************                       */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Replies that are sent a while after the request, run once instead of  */
+/* the loop waiting for them. sernoJob sends the serial number ~1.24 sec */
+/* after the request line, profileStartJob sends that the profile has    */
+/* started ~0.5 sec after startprofile, reattaches the interrupt to pin2 */
+/* and starts the continuous profiling samples. A reply isn't put in the */
+/* middle of an upload, the job runs again 1 ms later until it is done.  */
+/*                                                                       */
+/*************************************************************************/
+
+void sernoJob(void){
+  if(uploadType != UPLOAD_NONE){
+    startJob(JOB_SERNO, 1);
+    return;
+  }
+  writeBytes(msg);
+}
+
+void profileStartJob(void){
+  if(uploadType != UPLOAD_NONE){
+    startJob(JOB_PROFILESTART, 1);
+    return;
+  }
+  String cp2 = "\r\nprofile started, pump delay = 0 seconds\r\nS>";
+  writeBytes(cp2);
+  requestAttach(checkLine);
+  startJob(JOB_CP, 1000);
+}
+
+
+
+/*************************************************************************/
+/*                               oxygenJob                               */
+/*                               *********                               */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Sends the PTSO sample kept by startOxygenPump once the pump is done,  */
+/* nothing if the sample dropped out (the APFx times out as it would on  */
+/* a real one). Run once, again 1 ms later while an upload is being sent.*/
+/*                                                                       */
+/*************************************************************************/
+
+void oxygenJob(void){
+  if(uploadType != UPLOAD_NONE){
+    startJob(JOB_OXYGEN, 1);
+    return;
+  }
+  if(oxygenReply[0] != '\0'){
+    writeBytes(oxygenReply);
+  }
+}
+
+
+
+/*************************************************************************/
+/*                          replyLater, replyJob                         */
+/*                          ********************                         */
+/*                                                                       */
+/* parameters: reply, a const char * that represents the echo to send    */
+/*                  (empty for none)                                     */
+/*             wait, an unsigned long that represents how long (ms) from */
+/*                  now it is sent                                       */
+/*             attach, a boolean that represents if the interrupt to     */
+/*                  pin2 is reattached after it                          */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* A command handler doesn't wait before it echoes, replyLater keeps the */
+/* echo and the reply job sends it once the wait is over. Requests over  */
+/* the hardware lines and commands wait for it, so they are still        */
+/* answered in order.                                                    */
+/*                                                                       */
+/*************************************************************************/
+
+void replyLater(const char *reply, unsigned long wait, boolean attach){
+  strncpy(laterReply, reply, LATERSIZE-1);
+  laterReply[LATERSIZE-1] = '\0';
+  laterAttach = attach;
+  startJob(JOB_REPLY, wait);
+}
+
+void replyJob(void){
+  if(laterReply[0] != '\0'){
+    writeBytes(laterReply);
+  }
+  if(laterAttach){
+    requestAttach(checkLine);
+  }
+}
+
+
+
+/*************************************************************************/
+/*                               replayJob                               */
+/*                               *********                               */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Reads the window of the recorded profile getReplaySample asked for    */
+/* (replayNext) into the buffer it isn't sampling from, so the next      */
+/* window is there before the float gets to it.                          */
+/*                                                                       */
+/*************************************************************************/
+
+void replayJob(void){
+  if(replayNext < 0){
+    return;
+  }
+  loadReplayWindow(1 - replayAt, replayNext);
+  replayNext = -1;
+}
+
+
+
+/*************************************************************************/
+/*                                storeJob                               */
+/*                                ********                               */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Runs every STOREPERIOD ms while there is an SD card. Once             */
+/* STORETRACEBATCH trace events are waiting they are put in a block      */
+/* (storeTrace). Writes the full block (storeFull) to its file when the  */
+/* simulator is idle (storeIdle), then the block is the spare again.     */
+/* While syncing, the blocks that are partly filled are handed over and  */
+/* written one at a time the same way, then what the card library still  */
+/* holds is put on the card. With nothing to write, a file that isn't    */
+/* its full size yet gets a few more blocks (storeGrow).                 */
+/*                                                                       */
+/*************************************************************************/
+
+void storeJob(void){
+  int i;
+  
+  if((storeFull == NULL)&&(storeTraceWaiting >= STORETRACEBATCH)){
+    storeTrace();
+  }
+  if((storeFull == NULL)&&storeSync){
+    for(i = 0; i < STORAGEFILES; i++){
+      if(stores[i].open&&(stores[i].fillLen > STOREHEADERSIZE)){
+        storeBlock(i);
+        break;
+      }
+    }
+    if((i == STORAGEFILES)&&(storeTraceWaiting > 0)){
+      storeTrace();
+    }
+  }
+  if(!storeIdle()){
+    return;
+  }
+  if(storeFull != NULL){
+    if(storageWrite(storeFullStore, storeFullBlock, storeFull)){
+      stores[storeFullStore].written++;
+      if(stores[storeFullStore].allocated <= storeFullBlock){
+        stores[storeFullStore].allocated = storeFullBlock + 1;
+      }
+    }
+    else{
+      stores[storeFullStore].dropped += (storeFull[4] + (storeFull[5] << 8));
+    }
+    storeSpare = storeFull;
+    storeFull = NULL;
+    return;
+  }
+  if(storeSync){
+    for(i = 0; i < STORAGEFILES; i++){
+      if(stores[i].open){
+        storageSync(i);
+      }
+    }
+    storeSync = false;
+    return;
+  }
+  storeGrow();
+}
+
+
+
+/*************************************************************************/
+/*                              startUpload                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: type, an int that represents the upload to start          */
+/*                  (UPLOAD_DD, UPLOAD_DA, UPLOAD_DAH, UPLOAD_DAB,       */
+/*                  UPLOAD_TRACE, UPLOAD_FLASH, UPLOAD_STATS or          */
+/*                  UPLOAD_SCHED)                                        */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function gets ready to send a bulk upload. Nothing is sent here, */
+/* serviceUpload pulls the records one at a time from nextUploadRecord   */
+/* as Serial1 has room for them, so the upload never has to fit in RAM   */
+/* and only ever takes one record of memory no matter how long the       */
+/* profile is.                                                           */
+/*                                                                       */
+/*************************************************************************/
+
+void startUpload(int type){
+  uploadType = type;
+  uploadIndex = -1;
+  uploadPos = 0;
+  uploadLen = 0;
+  
+  //dd sends count+1 samples, d pressure increments (the range of the profile over count) for d
+  //from count down to 0, so from maxPress-minPress to 0
+  if(type == UPLOAD_DD){
+    uploadIncrement = 0;
+    if(count > 0){
+      uploadIncrement = (maxPress-minPress)/count;
+    }
+    uploadCount = count + 1;
+  }
+  
+  //dumptrace sends the events in the trace, which holds still until it is done
+  else if(type == UPLOAD_TRACE){
+    uploadCount = traceCount;
+    uploadCrc = 0xFFFF;
+  }
+  
+  //a flash reply has no header, it counts the fields (uploadIndex) and the bytes it has sent
+  //(for the trace), stats sends the parts of each row that is used and sched one line per job
+  else if(type == UPLOAD_FLASH){
+    uploadIndex = 0;
+    uploadCount = 0;
+  }
+  else if(type == UPLOAD_STATS){
+    uploadCount = statsUsed*STATSPARTS;
+  }
+  else if(type == UPLOAD_SCHED){
+    uploadCount = NJOBS;
+  }
+  
+  //da, dah and dab send nBins bins, binaverage starts over at the first bin
+  else{
+    inc = 0;
+    uploadCount = nBins;
+    uploadCrc = 0xFFFF;
+    if(type == UPLOAD_DA){
+      uploadEncoder = binToAscii;
+    }
+    else if(type == UPLOAD_DAH){
+      uploadEncoder = binToHex;
+    }
+    else{
+      uploadEncoder = binToBinary;
+    }
+  }
+}
+
+
+
+/*************************************************************************/
+/*                            nextUploadRecord                           */
+/*                            ****************                           */
+/*                                                                       */
+/* parameters: record, a char buffer of REPLYSIZE that the next record   */
+/*                  of the upload is written into                        */
+/*                                                                       */
+/* returns: an int that is the number of bytes of the record to send, 0  */
+/*                  once the upload is done                              */
+/*                                                                       */
+/* This function is the generator behind the bulk uploads, each call     */
+/* writes the next record: the echo of the command, then one sample (dd) */
+/* or one bin (da, dah, dab), then "upload complete". The records that   */
+/* were sent with writeBytes before are sent with their null, like       */
+/* always. The binary upload (dab) puts a header after the echo, the     */
+/* number of bins (2 bytes, most significant first) and the size of a    */
+/* bin, and the CRC-16 of the header and bins (2 bytes) before "upload   */
+/* complete". The trace upload (dumptrace) is laid out the same way with */
+/* events instead of bins. The long replies (a flash reply, stats and    */
+/* sched) are written by flashToRecord, statsToRecord and schedToRecord. */
+/*                                                                       */
+/*************************************************************************/
+
+int nextUploadRecord(char *record){
+  
+  //the long replies have records of their own
+  if(uploadType == UPLOAD_FLASH){
+    return flashToRecord(record);
+  }
+  if(uploadType == UPLOAD_STATS){
+    return statsToRecord(record);
+  }
+  if(uploadType == UPLOAD_SCHED){
+    return schedToRecord(record);
+  }
+  
+  //the echo of the command
+  if(uploadIndex < 0){
+    uploadIndex++;
+    if(uploadType == UPLOAD_DD){
+      return appendChars(record, "dd\r\n") - record;
+    }
+    if(uploadType == UPLOAD_DA){
+      return appendChars(record, "da\r\n") - record + 1;
+    }
+    if(uploadType == UPLOAD_DAH){
+      return appendChars(record, "dah\r\n") - record + 1;
+    }
+    if(uploadType == UPLOAD_TRACE){
+      byte *header = (byte *)appendChars(record, "dumptrace\r\n") + 1;
+      header[0] = uploadCount >> 8;
+      header[1] = uploadCount & 0xFF;
+      header[2] = TRACERECORDSIZE;
+      uploadCrc = crc16(uploadCrc, header, 3);
+      return (char *)header - record + 3;
+    }
+    byte *header = (byte *)appendChars(record, "dab\r\n") + 1;
+    header[0] = uploadCount >> 8;
+    header[1] = uploadCount & 0xFF;
+    header[2] = BINRECORDSIZE;
+    uploadCrc = crc16(uploadCrc, header, 3);
+    return (char *)header - record + 3;
+  }
+  
+  //the samples from the deepest to the shallowest, or the bins
+  if(uploadIndex < uploadCount){
+    if(uploadType == UPLOAD_DD){
+      getRawSample(uploadCount - 1 - uploadIndex, record);
+      uploadIndex++;
+      return strlen(record);
+    }
+    int len;
+    if(!HAS_CP || (uploadType == UPLOAD_TRACE)){
+      len = traceToBinary(record, uploadIndex);
+    }
+    else{
+      len = binaverage(record, uploadEncoder);
+    }
+    if((uploadType == UPLOAD_DAB)||(uploadType == UPLOAD_TRACE)){
+      uploadCrc = crc16(uploadCrc, (const byte *)record, len);
+    }
+    uploadIndex++;
+    return len;
+  }
+  
+  //send upload complete at end of all samples
+  if(uploadIndex == uploadCount){
+    uploadIndex++;
+    if(uploadType == UPLOAD_DD){
+      return appendChars(record, "upload complete\r\nS>") - record + 1;
+    }
+    if((uploadType == UPLOAD_DAB)||(uploadType == UPLOAD_TRACE)){
+      record[0] = uploadCrc >> 8;
+      record[1] = uploadCrc & 0xFF;
+      return appendChars(record + 2, "\r\nupload complete\r\nS>") - record + 1;
+    }
+    return appendChars(record, "\r\nupload complete\r\nS>") - record + 1;
+  }
+  return 0;
+}
+
+
+
+/*************************************************************************/
+/*                             flashToRecord                             */
+/*                             *************                             */
+/*                                                                       */
+/* parameters: record, a char buffer of REPLYSIZE that the next part of  */
+/*                  the flash reply is written into                      */
+/*                                                                       */
+/* returns: an int that is the number of bytes of the part to send, 0    */
+/*                  once the reply is done                               */
+/*                                                                       */
+/* This function copies the flash reply started by writeFlash into the   */
+/* record, up to the room a field needs from its end, putting the values */
+/* of the fields in as it reaches them. The last part ends with the null */
+/* of the text, like writeBytes sends, and adds the reply to the trace.  */
+/*                                                                       */
+/*************************************************************************/
+
+int flashToRecord(char *record){
+  char *end = record;
+  char next;
+  
+  while((uploadFlash != NULL)&&(end - record < REPLYSIZE - UPLOADFIELDSIZE)){
+    next = pgm_read_byte(uploadFlash++);
+    if(next == FIELDNUMBER[0]){
+      end = longToChars(end, uploadNumbers[uploadIndex++]);
+    }
+    else if(next == FIELDTEXT[0]){
+      end = appendChars(end, uploadText);
+      uploadText += strlen(uploadText) + 1;
+    }
+    else{
+      *end++ = next;
+      if(next == '\0'){
+        uploadFlash = NULL;
+        uploadCount += end - record;
+        trace(TRACE_TX, uploadCount);
+        return end - record;
+      }
+    }
+  }
+  uploadCount += end - record;
+  return end - record;
+}
+
+
+
+/*************************************************************************/
+/*                             statsToRecord                             */
+/*                             *************                             */
+/*                                                                       */
+/* parameters: record, a char buffer of REPLYSIZE that the next part of  */
+/*                  the stats reply is written into                      */
+/*                                                                       */
+/* returns: an int that is the number of bytes of the part to send, 0    */
+/*                  once the reply is done                               */
+/*                                                                       */
+/* This function writes the reply to stats a part at a time: how long    */
+/* the statistics cover and the names of the columns, then for each row  */
+/* its name and count, the latency (min, mean and max) and its           */
+/* histogram, and the reply size and its histogram (STATSPARTS), then    */
+/* the prompt.                                                           */
+/*                                                                       */
+/*************************************************************************/
+
+int statsToRecord(char *record){
+  char *end = record;
+  CommandStats *row;
+  int part, b;
+  
+  //the heading
+  if(uploadIndex < 0){
+    uploadIndex++;
+    end = appendChars(end, "\r\nstats for ");
+    end = longToChars(end, clockMillis() - statsSince);
+    return appendChars(end, " ms") - record;
+  }
+  if(uploadIndex == 0){
+    uploadIndex++;
+    end = appendChars(end, "\r\nname count latency(us) min mean max [<");
+    return longToChars(end, STATSLATENCY) - record;
+  }
+  if(uploadIndex == 1){
+    uploadIndex++;
+    end = appendChars(end, " x4...] bytes min mean max [<");
+    end = longToChars(end, STATSBYTES);
+    return appendChars(end, " x4...]") - record;
+  }
+  
+  //the rows
+  if(uploadIndex - 2 < uploadCount){
+    row = &stats[(uploadIndex - 2)/STATSPARTS];
+    part = (uploadIndex - 2)%STATSPARTS;
+    uploadIndex++;
+    if(part == 0){
+      end = appendChars(end, "\r\n");
+      if(row->key == STATSOTHER){
+        end = appendChars(end, "other");
+      }
+      else if(row->key >= STATSLINE){
+        end = appendChars(end, (row->key == STATSLINE + SERNO) ? "serno line" : 
+        (row->key == STATSLINE + PTS) ? "pts line" : (row->key == STATSLINE + PT) ? "pt line" : "p line");
+      }
+      else if(commandChar(row->key, 0) == 0){
+        end = appendChars(end, "<cr>");
+      }
+      else{
+        strcpy_P(end, commands[row->key].name);
+        end += strlen(end);
+      }
+      end = appendChars(end, " ");
+      return longToChars(end, row->count) - record;
+    }
+    if(part == 1){
+      end = appendChars(end, " latency ");
+      end = longToChars(end, row->latencyMin);
+      end = appendChars(end, " ");
+      end = longToChars(end, row->latencySum/row->count);
+      end = appendChars(end, " ");
+      return longToChars(end, row->latencyMax) - record;
+    }
+    if(part == 3){
+      end = appendChars(end, " bytes ");
+      end = longToChars(end, row->bytesMin);
+      end = appendChars(end, " ");
+      end = longToChars(end, row->bytesSum/row->count);
+      end = appendChars(end, " ");
+      return longToChars(end, row->bytesMax) - record;
+    }
+    end = appendChars(end, " [");
+    for(b = 0; b < STATSBUCKETS; b++){
+      end = longToChars(end, (part == 2) ? row->latencyHistogram[b] : row->bytesHistogram[b]);
+      end = appendChars(end, (b < STATSBUCKETS - 1) ? " " : "]");
+    }
+    return end - record;
+  }
+  
+  //the prompt, with its null
+  if(uploadIndex - 2 == uploadCount){
+    uploadIndex++;
+    return appendChars(end, "\r\nS>") - record + 1;
+  }
+  return 0;
+}
+
+
+
+/*************************************************************************/
+/*                             schedToRecord                             */
+/*                             *************                             */
+/*                                                                       */
+/* parameters: record, a char buffer of REPLYSIZE that the next line of  */
+/*                  the sched reply is written into                      */
+/*                                                                       */
+/* returns: an int that is the number of bytes of the line to send, 0    */
+/*                  once the reply is done                               */
+/*                                                                       */
+/* This function writes the reply to sched a line at a time: the names   */
+/* of the columns, then for each job its name, period (ms), runs,        */
+/* overruns and the latest (ms) it has run, then the prompt.             */
+/*                                                                       */
+/*************************************************************************/
+
+int schedToRecord(char *record){
+  char *end = record;
+  Job *job;
+  
+  if(uploadIndex < 0){
+    uploadIndex++;
+    return appendChars(end, "\r\njob period runs overruns late") - record;
+  }
+  if(uploadIndex < uploadCount){
+    job = &jobs[uploadIndex++];
+    end = appendChars(end, "\r\n");
+    end = appendChars(end, job->name);
+    end = appendChars(end, " ");
+    end = longToChars(end, job->period);
+    end = appendChars(end, " ");
+    end = longToChars(end, job->runs);
+    end = appendChars(end, " ");
+    end = longToChars(end, job->overruns);
+    end = appendChars(end, " ");
+    return longToChars(end, job->lateMax) - record;
+  }
+  if(uploadIndex == uploadCount){
+    uploadIndex++;
+    return appendChars(end, "\r\nS>") - record + 1;
+  }
+  return 0;
+}
+
+
+
+/*************************************************************************/
+/*                                 crc16                                 */
+/*                                 *****                                 */
+/*                                                                       */
+/* parameters: crc, an unsigned int that is the CRC so far (0xFFFF to    */
+/*                  start)                                               */
+/*             data, the bytes to add to the CRC                         */
+/*             len, an int that is the number of bytes in data           */
+/*                                                                       */
+/* returns: an unsigned int that is the CRC with the bytes added         */
+/*                                                                       */
+/* This function works out a CRC-16/CCITT (polynomial 0x1021, most       */
+/* significant bit first) a few bytes at a time, so the CRC of an upload */
+/* is kept up as its records are sent.                                   */
+/*                                                                       */
+/*************************************************************************/
+
+unsigned int crc16(unsigned int crc, const byte *data, int len){
+  int i, bit;
+  for(i = 0; i < len; i++){
+    crc ^= (unsigned int)data[i] << 8;
+    for(bit = 0; bit < 8; bit++){
+      if(crc & 0x8000){
+        crc = (crc << 1) ^ 0x1021;
+      }
+      else{
+        crc <<= 1;
+      }
+    }
+  }
+  return crc & 0xFFFF;
+}
+
+
+
+/*************************************************************************/
+/*                                 trace                                 */
+/*                                 *****                                 */
+/*                                                                       */
+/* parameters: type, a byte that represents the event (TRACE_*)          */
+/*             data, an unsigned int that goes with the event: the row   */
+/*                  of the command table (TRACE_RX, 0xFFFF for a line    */
+/*                  that isn't a command), the bytes of a reply once it  */
+/*                  is all queued (TRACE_TX), the request decoded from   */
+/*                  the hardware lines (TRACE_LINE), the phase before    */
+/*                  (high byte) and after (low byte) a change            */
+/*                  (TRACE_PHASE), the piston position (TRACE_PISTON) or */
+/*                  the baud rate/100 that was given up on because no    */
+/*                  command came in at it (TRACE_BAUD)                   */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function records an event in traceRing with the time it          */
+/* happened. It only writes 7 bytes of RAM, so unlike printing on Serial */
+/* it doesn't change the timing it is there to show. While the trace is  */
+/* being uploaded it holds still, the events are dropped. The events     */
+/* also wait in traceRing to go to TRACE.BIN (storeTrace).               */
+/*                                                                       */
+/*************************************************************************/
+
+void trace(byte type, unsigned int data){
+  TraceEvent *event;
+  
+  if(uploadType == UPLOAD_TRACE){
+    return;
+  }
+  event = &traceRing[traceHead];
+  event->time = clockMillis();
+  event->type = type;
+  event->data = data;
+  traceHead = (traceHead + 1) % TRACESIZE;
+  if(traceCount < TRACESIZE){
+    traceCount++;
+  }
+  
+  //and for the SD card, the store job takes it from traceRing, the oldest waiting event is
+  //lost once the ring has gone all the way round
+  if(stores[STORE_TRACE].open){
+    if(storeTraceWaiting < TRACESIZE){
+      storeTraceWaiting++;
+    }
+    else{
+      stores[STORE_TRACE].dropped++;
+    }
+  }
+}
+
+
+
+/*************************************************************************/
+/*                             traceToBinary                             */
+/*                             *************                             */
+/*                                                                       */
+/* parameters: record, a char buffer of REPLYSIZE that the event is      */
+/*                  written into                                         */
+/*             n, an int that represents which event to write, 0 is the  */
+/*                  oldest in the trace                                  */
+/*                                                                       */
+/* returns: an int that is the number of bytes of the event to send      */
+/*                  (TRACERECORDSIZE)                                    */
+/*                                                                       */
+/* This function writes an event for the 'dumptrace' command: the time   */
+/* (ms, 4 bytes), the event (TRACE_*) and its data (2 bytes), most       */
+/* significant byte first.                                               */
+/*                                                                       */
+/*************************************************************************/
+
+int traceToBinary(char *record, int n){
+  TraceEvent *event = &traceRing[(traceHead + TRACESIZE - traceCount + n) % TRACESIZE];
+  record[0] = event->time >> 24;
+  record[1] = (event->time >> 16) & 0xFF;
+  record[2] = (event->time >> 8) & 0xFF;
+  record[3] = event->time & 0xFF;
+  record[4] = event->type;
+  record[5] = event->data >> 8;
+  record[6] = event->data & 0xFF;
+  return TRACERECORDSIZE;
+}
+
+
+
+/*************************************************************************/
+/*                              startStores                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function opens the files recorded to on the SD card (CP.BIN and  */
+/* TRACE.BIN) and counts up the run number kept in the EEPROM. A new     */
+/* file is made its full size by the store job, a few blocks at a time,  */
+/* so its size and clusters stop changing once that is done. Every run   */
+/* writes its files from the first block, a block is a STOREHEADERSIZE   */
+/* byte header, the run (2 bytes), the block (2 bytes), the number of    */
+/* records (2 bytes) and the size of a record (2 bytes), then the        */
+/* records, all little endian. The store job is only started if there    */
+/* is a card.                                                            */
+/*                                                                       */
+/*************************************************************************/
+
+void startStores(void){
+  boolean any = false;
+  long blocks;
+  int i;
+  
+  for(i = 0; i < STORAGEFILES; i++){
+    blocks = storageOpen(i, stores[i].name);
+    stores[i].open = (blocks >= 0);
+    stores[i].allocated = (blocks > 0) ? blocks : 0;
+    stores[i].next = 0;
+    stores[i].fillLen = STOREHEADERSIZE;
+    any = any || stores[i].open;
+  }
+  storeTraceWaiting = 0;
+  if(!any){
+    return;
+  }
+  EEPROM.get(STOREADDRESS, storeRun);
+  storeRun++;
+  EEPROM.put(STOREADDRESS, storeRun);
+  startJob(JOB_STORE, STOREPERIOD);
+}
+
+
+
+/*************************************************************************/
+/*                                putLong                                */
+/*                                *******                                */
+/*                                                                       */
+/* parameters: bytes, where the value is written                         */
+/*             value, an unsigned long                                   */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Writes a value as 4 bytes, least significant first.                   */
+/*                                                                       */
+/*************************************************************************/
+
+void putLong(byte *bytes, unsigned long value){
+  bytes[0] = value & 0xFF;
+  bytes[1] = (value >> 8) & 0xFF;
+  bytes[2] = (value >> 16) & 0xFF;
+  bytes[3] = value >> 24;
+}
+
+
+
+/*************************************************************************/
+/*                        storeRecord, storeSample                       */
+/*                        ************************                       */
+/*                                                                       */
+/* parameters: store, a byte that represents the store (STORE_CP or      */
+/*                  STORE_TRACE)                                         */
+/*             record, the record (the size of a record of the store)    */
+/*             pressure, temperature, salinity, longs of the sample      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* These functions add a record to the block a store is filling, only a  */
+/* copy, nothing is written to the card here. The block is handed to the */
+/* store job as soon as another record won't fit in it. storeSample is   */
+/* the record of a continuous profile sample, the time (ms), pressure    */
+/* (hundredths of a dbar), temperature and salinity (ten thousandths).   */
+/*                                                                       */
+/*************************************************************************/
+
+void storeRecord(byte store, const byte *record){
+  Store *s = &stores[store];
+  
+  if(!s->open){
+    return;
+  }
+  memcpy(s->fill + s->fillLen, record, s->recordSize);
+  s->fillLen += s->recordSize;
+  if(s->fillLen + s->recordSize > STORAGEBLOCK){
+    storeBlock(store);
+  }
+}
+
+void storeSample(long pressure, long temperature, long salinity){
+  byte record[STORECPRECORDSIZE];
+  
+  if(!stores[STORE_CP].open){
+    return;
+  }
+  putLong(record, clockMillis());
+  putLong(record + 4, pressure);
+  putLong(record + 8, temperature);
+  putLong(record + 12, salinity);
+  storeRecord(STORE_CP, record);
+}
+
+
+
+/*************************************************************************/
+/*                               storeBlock                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: store, a byte that represents the store                   */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function hands the block a store is filling to the store job, if */
+/* it has any records: its header is filled in, it becomes storeFull and */
+/* the store fills the spare block from now on. If the last full block   */
+/* hasn't been written yet (there is no spare) or the file is full, the  */
+/* records of the block are dropped and counted instead, the simulator   */
+/* never waits for the card.                                             */
+/*                                                                       */
+/*************************************************************************/
+
+void storeBlock(byte store){
+  Store *s = &stores[store];
+  int records = (s->fillLen - STOREHEADERSIZE)/s->recordSize;
+  
+  if(records == 0){
+    return;
+  }
+  if((storeFull != NULL)||(s->next >= s->blocks)){
+    s->dropped += records;
+    s->fillLen = STOREHEADERSIZE;
+    return;
+  }
+  s->fill[0] = storeRun & 0xFF;
+  s->fill[1] = storeRun >> 8;
+  s->fill[2] = s->next & 0xFF;
+  s->fill[3] = (s->next >> 8) & 0xFF;
+  s->fill[4] = records & 0xFF;
+  s->fill[5] = records >> 8;
+  s->fill[6] = s->recordSize;
+  s->fill[7] = 0;
+  memset(s->fill + s->fillLen, 0, STORAGEBLOCK - s->fillLen);
+  storeFull = s->fill;
+  storeFullStore = store;
+  storeFullBlock = s->next++;
+  s->fill = storeSpare;
+  s->fillLen = STOREHEADERSIZE;
+  storeSpare = NULL;
+}
+
+
+
+/*************************************************************************/
+/*                               storeTrace                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function puts the trace events waiting in traceRing in the spare */
+/* block, oldest first, and hands it to the store job like a full block  */
+/* of CP.BIN, so TRACE.BIN needs no block of RAM of its own. A record is */
+/* the time (4 bytes), type, 0 and data (2 bytes), little endian. Only   */
+/* called while there is a spare (storeFull is NULL).                    */
+/*                                                                       */
+/*************************************************************************/
+
+void storeTrace(void){
+  Store *s = &stores[STORE_TRACE];
+  TraceEvent *event;
+  byte *record;
+  
+  s->fill = storeSpare;
+  s->fillLen = STOREHEADERSIZE;
+  while((storeTraceWaiting > 0)&&(s->fillLen + s->recordSize <= STORAGEBLOCK)){
+    event = &traceRing[(traceHead + TRACESIZE - storeTraceWaiting) % TRACESIZE];
+    record = s->fill + s->fillLen;
+    putLong(record, event->time);
+    record[4] = event->type;
+    record[5] = 0;
+    record[6] = event->data & 0xFF;
+    record[7] = event->data >> 8;
+    s->fillLen += s->recordSize;
+    storeTraceWaiting--;
+  }
+  storeBlock(STORE_TRACE);
+  
+  //the block is storeFull now (or still the spare if the file was full)
+  s->fill = NULL;
+  s->fillLen = STOREHEADERSIZE;
+}
+
+
+
+/*************************************************************************/
+/*                               storeGrow                               */
+/*                               *********                               */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function adds STOREGROWBLOCKS blocks of zeros (the spare, which  */
+/* is free) to the end of the first file that isn't its full size yet,   */
+/* and puts its new size on the card once it is. It is run by the store  */
+/* job while idle, so the file is made a few ms at a time instead of     */
+/* holding up the start for minutes. Until then a block of records past  */
+/* the end just makes the file a block longer.                           */
+/*                                                                       */
+/*************************************************************************/
+
+void storeGrow(void){
+  Store *s;
+  int i, n;
+  
+  for(i = 0; i < STORAGEFILES; i++){
+    s = &stores[i];
+    if(!s->open||(s->allocated >= s->blocks)){
+      continue;
+    }
+    memset(storeSpare, 0, STORAGEBLOCK);
+    for(n = 0; (n < STOREGROWBLOCKS)&&(s->allocated < s->blocks); n++){
+      if(!storageWrite(i, s->allocated, storeSpare)){
+        return;
+      }
+      s->allocated++;
+    }
+    if(s->allocated == s->blocks){
+      storageSync(i);
+    }
+    return;
+  }
+}
+
+
+
+/*************************************************************************/
+/*                               storeIdle                               */
+/*                               *********                               */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: a boolean that is true if a block can be written now         */
+/*                                                                       */
+/* A block is only written while the simulator has nothing else to do:   */
+/* no request is being decoded on the hardware lines, no command is      */
+/* being received, no reply or upload is waiting to be sent and the      */
+/* next continuous profile sample isn't due within STOREGUARD ms. So a   */
+/* write to the card never holds up a reply or a sample, at worst the    */
+/* block waits for the next run of the store job.                        */
+/*                                                                       */
+/*************************************************************************/
+
+boolean storeIdle(void){
+  if((lineTicks >= 0)||(interruptMessage != 0)||(rxHead != rxTail)||(cmdLen > 0)){
+    return false;
+  }
+  if((txHead != txTail)||(uploadType != UPLOAD_NONE)){
+    return false;
+  }
+  if((JOB_CP < NJOBS)&&jobs[JOB_CP].active&&(long(jobs[JOB_CP].next - clockMillis()) < STOREGUARD)){
+    return false;
+  }
+  return true;
+}
+
+
+
+/*************************************************************************/
+/*                               startStats                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: key, an int that represents the request: the row of the   */
+/*                  command table or STATSLINE + the hardware line       */
+/*                  request (SERNO, PTS, PT or P)                        */
+/*             since, an unsigned long that represents the time (us) the */
+/*                  request was received                                 */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function adds the request before to the statistics (endStats)    */
+/* and starts measuring this one: serviceTx notes when the first byte of */
+/* its reply goes, and txWrite counts the bytes queued until the next    */
+/* request (the samples of continuous profiling and the uploads count    */
+/* for the command that started them). A command is received when its    */
+/* carriage return is taken from rxBuffer, right after it arrives unless */
+/* the loop is busy, a hardware line request when the request line rose. */
+/*                                                                       */
+/*************************************************************************/
+
+void startStats(int key, unsigned long since){
+  endStats();
+  statsKey = key;
+  statsStart = since;
+  statsBytes = 0;
+  statsWaiting = true;
+}
+
+
+
+/*************************************************************************/
+/*                                endStats                               */
+/*                                ********                               */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function adds the latency and reply size of the request being    */
+/* measured to its row of stats. A request that wasn't answered (no byte */
+/* of a reply was sent) isn't counted. Neither is one that would take    */
+/* the count past STATSCOUNTMAX or wrap a sum, the row keeps what it has */
+/* until stats reset. A histogram bucket that is full stays at           */
+/* STATSBUCKETMAX, it reads "at least that many".                        */
+/*                                                                       */
+/*************************************************************************/
+
+void endStats(void){
+  CommandStats *row;
+  unsigned long latency;
+  byte bucket;
+  
+  if(statsWaiting||(statsKey == STATSOTHER)){
+    statsWaiting = false;
+    return;
+  }
+  row = &stats[statsRow(statsKey)];
+  latency = statsFirst - statsStart;
+  statsKey = STATSOTHER;
+  
+  //a full row stops counting
+  if((row->count == STATSCOUNTMAX)||(row->latencySum + latency < row->latencySum)||
+  (row->bytesSum + statsBytes < row->bytesSum)){
+    return;
+  }
+  if((row->count == 0)||(latency < row->latencyMin)){
+    row->latencyMin = latency;
+  }
+  if(latency > row->latencyMax){
+    row->latencyMax = latency;
+  }
+  if((row->count == 0)||(statsBytes < row->bytesMin)){
+    row->bytesMin = statsBytes;
+  }
+  if(statsBytes > row->bytesMax){
+    row->bytesMax = statsBytes;
+  }
+  row->latencySum += latency;
+  row->bytesSum += statsBytes;
+  bucket = statsBucket(latency, STATSLATENCY);
+  if(row->latencyHistogram[bucket] < STATSBUCKETMAX){
+    row->latencyHistogram[bucket]++;
+  }
+  bucket = statsBucket(statsBytes, STATSBYTES);
+  if(row->bytesHistogram[bucket] < STATSBUCKETMAX){
+    row->bytesHistogram[bucket]++;
+  }
+  row->count++;
+}
+
+
+
+/*************************************************************************/
+/*                                statsRow                               */
+/*                                ********                               */
+/*                                                                       */
+/* parameters: key, an int that represents the request (see startStats)  */
+/*                                                                       */
+/* returns: an int that is the row of stats the request is counted in    */
+/*                                                                       */
+/* This function finds the row of a request, or gives it the next free   */
+/* one. Once only the last row is left, it is "other" and every request  */
+/* without a row of its own is counted there.                            */
+/*                                                                       */
+/*************************************************************************/
+
+int statsRow(int key){
+  int i;
+  for(i = 0; i < statsUsed; i++){
+    if(stats[i].key == key){
+      return i;
+    }
+  }
+  if(statsUsed == STATSROWS){
+    return STATSROWS - 1;
+  }
+  if(statsUsed == STATSROWS - 1){
+    key = STATSOTHER;
+  }
+  stats[statsUsed].key = key;
+  return statsUsed++;
+}
+
+
+
+/*************************************************************************/
+/*                               statsBucket                             */
+/*                               ***********                             */
+/*                                                                       */
+/* parameters: value, an unsigned long that is a latency or reply size   */
+/*             first, an unsigned long that is where the first bucket    */
+/*                  ends                                                 */
+/*                                                                       */
+/* returns: a byte that is the bucket of the histogram the value is in,  */
+/*                  bucket b holds the values under first*4^b and the    */
+/*                  last one the rest                                    */
+/*                                                                       */
+/*************************************************************************/
+
+byte statsBucket(unsigned long value, unsigned long first){
+  byte bucket = 0;
+  while((value >= first)&&(bucket < STATSBUCKETS - 1)){
+    value >>= 2;
+    bucket++;
+  }
+  return bucket;
+}
+
+
+
+/*************************************************************************/
+/*                              getRawSample                             */
+/*                              ************                             */
+/*                                                                       */
+/* parameters: d, an int that represents which sample of the profile to  */
+/*                  write, 0 is the shallowest                           */
+/*             record, a char buffer of REPLYSIZE that the sample is     */
+/*                  written into                                         */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function writes one sample of the dd upload, "p, t, s" (or "p"   */
+/* for p only real-time output). The pressure is d pressure increments,  */
+/* the temperature and salinity are looked up with getWaterSample, the   */
+/* same as getReadingFromPiston.                                         */
+/*                                                                       */
+/*************************************************************************/
+
+void getRawSample(int d, char *record){
+  long pressure;
+  long temperature;
+  long salinity;
+  
+  pressure = long(d*uploadIncrement*100);
+  if(pOrPTSsel==0){
+    readingToChars(record, P, pressure, 0, 0, 0);
+  }
+  else{
+    getWaterSample(pressure, &temperature, &salinity, NULL);
+    readingToChars(record, PTS, pressure, temperature, salinity, 0);
+  }
+}
+
+
+
+/*************************************************************************/
+/*                             serviceUpload                             */
+/*                             *************                             */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* Called every time through the loop while an upload is being sent.     */
+/* This function only queues as many bytes as fit in txBuffer right now, */
+/* pulling the next record from nextUploadRecord when the last one is    */
+/* all queued, so it never waits on the UART. The upload goes out as     */
+/* fast as the baud rate allows. When it is done, the bin averaging      */
+/* variables are reset for the next dump.                                */
+/*                                                                       */
+/*************************************************************************/
+
+void serviceUpload(void){
+  int sent;
+  
+  while(uploadType != UPLOAD_NONE){
+    
+    //the last record is all sent, get the next one
+    if(uploadPos == uploadLen){
+      uploadPos = 0;
+      uploadLen = nextUploadRecord(uploadRecord);
+      if(uploadLen == 0){
+        uploadType = UPLOAD_NONE;
+        inc = 0;
+        return;
+      }
+    }
+    
+    //queue what fits without waiting
+    sent = txWrite((const byte *)uploadRecord + uploadPos, uploadLen - uploadPos);
+    uploadPos += sent;
+    serviceTx();
+    if(sent == 0){
+      return;
+    }
+  }
+}
+
+
+
+/*************************************************************************/
+/*                               resetBins                               */
+/*                               *********                               */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function empties all of the bins and the sample count, it is run */
+/* when a profile is started.                                            */
+/*                                                                       */
+/*************************************************************************/
+
+void resetBins(void){
+  memset(bins, 0, sizeof(bins));
+  nBins = 0;
+  count = 0;
+}
+
+
+
+/*************************************************************************/
+/*                               binIndex                                */
+/*                               ********                                */
+/*                                                                       */
+/* parameters: pressure, a long in hundredths of a dbar                  */
+/*                                                                       */
+/* returns: an int that is the bin the pressure falls in, counting from  */
+/*                  the surface, or -1 if it is between bins (size less  */
+/*                  than interval) or deeper than the last bin           */
+/*                                                                       */
+/* This function works out the bin straight from the bin settings, the   */
+/* top bins are from the surface to top max, the middle bins from top    */
+/* max to middle max and the bottom bins below that. A new bin starts    */
+/* every interval of the section and takes the samples within size of    */
+/* its start.                                                            */
+/*                                                                       */
+/*************************************************************************/
+
+int binIndex(long pressure){
+  long start, interval, size, part, bin;
+  int topBins, middleBins;
+  
+  if(pressure < 0){
+    return -1;
+  }
+  
+  //how many bins are in the top and middle sections
+  topBins = (topBinMax + topBinInterval - 1)/topBinInterval;
+  middleBins = 0;
+  if(middleBinMax > topBinMax){
+    middleBins = (middleBinMax - topBinMax + middleBinInterval - 1)/middleBinInterval;
+  }
+  
+  //the section the pressure is in
+  if(pressure < topBinMax*100L){
+    start = 0;
+    interval = topBinInterval*100L;
+    size = topBinSize*100L;
+    bin = 0;
+  }
+  else if(pressure < middleBinMax*100L){
+    start = topBinMax*100L;
+    interval = middleBinInterval*100L;
+    size = middleBinSize*100L;
+    bin = topBins;
+  }
+  else{
+    start = middleBinMax*100L;
+    if(middleBinMax < topBinMax){
+      start = topBinMax*100L;
+    }
+    interval = bottomBinInterval*100L;
+    size = bottomBinSize*100L;
+    bin = topBins + middleBins;
+  }
+  
+  part = pressure - start;
+  bin += part/interval;
+  if((part%interval >= size)||(bin >= MAXBINS)){
+    return -1;
+  }
+  return int(bin);
+}
+
+
+
+/*************************************************************************/
+/*                                addToBin                               */
+/*                                ********                               */
+/*                                                                       */
+/* parameters: pressure, a long in hundredths of a dbar                  */
+/*             temperature, salinity, longs in ten thousandths           */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function counts a sample of continuous profiling and adds it to  */
+/* the running sums of its bin, so the bins are averaged as the profile  */
+/* goes and nothing has to be kept of the samples themselves.            */
+/*                                                                       */
+/*************************************************************************/
+
+void addToBin(long pressure, long temperature, long salinity){
+  int bin = binIndex(pressure);
+  
+  count++;
+  if((bin < 0)||(bins[bin].samples >= MAXBINSAMPLES)){
+    return;
+  }
+  bins[bin].pressure += pressure;
+  bins[bin].temperature += temperature;
+  bins[bin].salinity += salinity;
+  bins[bin].samples++;
+  if(bin >= nBins){
+    nBins = bin + 1;
+  }
+}
+
+
+
+/*************************************************************************/
+/*                             setBinSetting                             */
+/*                             *************                             */
+/*                                                                       */
+/* parameters: setting, the bin setting to change                        */
+/*             value, the new value of the setting (dbar)                */
+/*             name, the command that changes the setting                */
+/*             text, the value as it was sent                            */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function changes one of the bin settings and echoes the command  */
+/* back. A value less than 1 dbar is echoed but not used, so a bin can't */
+/* have no size.                                                         */
+/*                                                                       */
+/*************************************************************************/
+
+void setBinSetting(int *setting, long value, const char *name, const char *text){
+  if(value >= 1){
+    *setting = value;
+  }
+  String echo = "\r\nS>"+String(name)+String(text);
+  replyLater(echo.c_str(), 10, false);
+}
+
+
+
+/*************************************************************************/
+/*                                setNoise                               */
+/*                                ********                               */
+/*                                                                       */
+/* parameters: setting, a pointer to the setting of the noise model      */
+/*             value, a long that represents the new value               */
+/*             max, a long that represents the largest value allowed     */
+/*             name, text, the name of the setting and the value as it   */
+/*                  was sent, for the reply                              */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function sets a sigma or rate of the noise model if it is from   */
+/* 0 to max and sends back the new value, noise is on while any of them  */
+/* is more than 0.                                                       */
+/*                                                                       */
+/*************************************************************************/
+
+void setNoise(long *setting, long value, long max, const char *name, const char *text){
+  int i;
+  if((value < 0)||(value > max)){
+    String badNoise = "\r\nnoise "+String(name)+String(text)+" not supported (0-"+String(max)+")\r\nS>";
+    writeBytes(badNoise);
+    return;
+  }
+  *setting = value;
+  noiseOn = (noiseSpike > 0)||(noiseDropout > 0);
+  for(i = 0; i < NOISECHANNELS; i++){
+    noiseOn = noiseOn||(noiseSigma[i] > 0);
+  }
+  String noise = "\r\nnoise "+String(name)+String(value)+"\r\nS>";
+  writeBytes(noise);
+}
+
+
+
+/*************************************************************************/
+/*                            continuousProfile                          */
+/*                            *****************                          */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function writes a P or PTS reading once every second while in cp */
+/* mode based on the whether it is in mission mode and whether the       */
+/* real-time output is set to P or PTS, adds the reading to its bin,     */
+/* also handle turning off continuous profiling if the pressure is less  */
+/* than p cut off                                                        */
+/*                                                                       */
+/*************************************************************************/
+
+void continuousProfile(void){
+
+  float aPressure;
+  char reply[REPLYSIZE];
+  
+  //calculate a float value for the pressure as well as send a reading over serial
+  //as a series of bytes
+  
+  //if in mission
+  if(HAS_MISSION && (missionMode>=100)){
+    
+    //the pressure at this point of the mission, from the schedule
+    aPressure = missionPressure(missionTime)/100.0;
+    
+    //send a reading over serial
+    
+    //if real-time output is P only
+    if(pOrPTSsel==0){
+      getDynamicReading(P, reply);
+    }
+    
+    //if real-time output is PTS
+    else{
+      getDynamicReading(PTS, reply);
+    }
+    //the real-time output isn't sent into the middle of a long reply (?, stats...), the sample
+    //is still averaged
+    if((reply[0] != '\0')&&(uploadType == UPLOAD_NONE)){
+      writeBytes(reply);
+    }
+    addToBin(readingPressure, readingTemperature, readingSalinity);
+  }
+  
+  //if not in a mission
+  else{
+    
+    //calculate the pressure based on the piston position
+    int voltage = readPiston();
+  
+    //technically out of range, but use it to go to a pressure greater than 2000dbar, min change = 5dbar
+    if(voltage<72){
+      aPressure = 2000+1*(voltage-72);
+    }
+    
+    //for pressures between 2000-1000dbar, 72 = 2000dbar, 293 = 1000dbar, min change = 4.5045dbar
+    else if((voltage>=72)&&(voltage<294)){
+      aPressure = ((4.5045)*(222-(voltage-72)))+1000.00;
+    }
+    
+    //for pressures between 1000-500dbar, 294 = 1000dbar, 453 = 500dbar, min change = 3.125dbar
+    else if((voltage>=294)&&(voltage<454)){
+      aPressure = ((3.125)*(160-(voltage-294)))+500.00;
+    }
+    
+    //for pressures between 500-0dbar, 454 = 500dbar, 1023 = 0dbar, min change = 0.878dbar
+    else{
+      aPressure = ((0.878)*(569-(voltage-454)));
+    }
+    
+    //send a reading over serial
+    
+    //if real-time output is P only
+    if(pOrPTSsel==0){
+      getReadingFromPiston(P, reply);
+    }
+    
+    //if real-time output is PTS
+    else{
+      getReadingFromPiston(PTS, reply);
+    }
+    //the real-time output isn't sent into the middle of a long reply (?, stats...), the sample
+    //is still averaged
+    if((reply[0] != '\0')&&(uploadType == UPLOAD_NONE)){
+      writeBytes(reply);
+    }
+    addToBin(readingPressure, readingTemperature, readingSalinity);
+  }
+  storeSample(readingPressure, readingTemperature, readingSalinity);
+     
+  //if the pressure calculated through the desired algorithm is less than 2 (which
+  //is the default p cut off), exit continuous profiling
+  if(aPressure < 2){
+    cpMode = -1;
+    if(uploadType == UPLOAD_NONE){
+      String exitcp = "profile stopped";
+      writeBytes(exitcp);
+    }
+    
+    //not into the middle of an upload, cpJob sends it once the upload is done
+    else{
+      cpStopReply = true;
+      startJob(JOB_CP, 1);
+    }
+  }
+}
+
+
+/*************************************************************************/
+/*                           checkPistonSurface                          */
+/*                           ******************                          */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function determines whether the simulator should leave prelude   */
+/* based on whether the piston position is decreasing. If it is, set the */
+/* prelude equal to the current mission time. This will effectively end  */
+/* prelude phase in terms of calculating in the code. Also, set the last */
+/* update to the timer value. Last, reset the values of last postion and */
+/* current position if the phase is changing.                            */
+/*                                                                       */
+/*************************************************************************/
+
+void checkPistonSurface(void){
+  updateTime();
+  
+  //get the value of the potentiometer
+  currentPosition = readPiston();
+  trace(TRACE_PISTON, currentPosition);
+  
+  //wait until there are 2 readings to compare
+  if(lastPosition!=0){
+    
+    //if it is descending
+    if(currentPosition < lastPosition - 5){
+      
+      //set it to park descent phase
+      currentPhase = PARKDESCENT;
+      
+      //reset all of the parameters to their values from the 
+      //start of the mission by setting them equal to their copy values
+      //and get rid of the prelude by setting the prelude time = 0
+      preludeDisplay = 0;
+      missionTime = 0;
+      missionTimeDisplay = 80;
+      parkDescentTime = parkDescentTimeCopy;
+      parkDescentTimeDisplay = parkDescentTime/60000;
+      downTime = downTimeCopy;
+      downTimeDisplay = downTime/60000;
+      deepProfileDescentTime = deepProfileDescentTimeCopy;
+      deepProfileDescentTimeDisplay = deepProfileDescentTime/60000;
+      ascentTimeOut = ascentTimeOutCopy;
+      ascentTime = ascentTimeCopy;
+      ascentTimeOutDisplay = ascentTimeOut/60000;
+      buildMissionSchedule();
+       
+      //set last update
+      lastUpdate = missionClock() - 80000;
+      
+      //reset values of currentPosition and lastPosition
+      currentPosition = 0;
+    }
+  }
+  lastPosition=currentPosition;
+}
+
+/*************************************************************************/
+/*                             checkPistonPark                           */
+/*                             ***************                           */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function determines whether the simulator should leave prelude   */
+/* based on whether the piston position is decreasing. If it is, set the */
+/* prelude equal to the current mission time. This will effectively end  */
+/* prelude phase in terms of calculating in the code. Also, set the last */
+/* update to the timer value. Last, reset the values of last postion and */
+/* current position if the phase is changing.                            */
+/*                                                                       */
+/*************************************************************************/
+
+void checkPistonPark(void){
+  updateTime();
+  readPiston();
+  currentPosition= readPiston();
+  trace(TRACE_PISTON, currentPosition);
+  if(lastPosition!=0){
+    
+    //if it is ascending
+    if(currentPosition > lastPosition + 5){
+      
+      //store the normal value of downTime to be reset later
+      downTimeCopy = downTime;
+      
+      //store the normal value of deepProfileDescentTime to be reset later
+      deepProfileDescentTimeCopy = deepProfileDescentTime;
+      
+      //store the normal value of ascentToPark to be reset later
+      ascentToParkCopy = ascentToPark;
+      
+      //set deepProfileDescentTime to 0 so that the phase is skipped for this cycle
+      deepProfileDescentTime = 0;
+      deepProfileDescentTimeCopy = 0;
+      
+      //set ascentToPark to 0 so that the phase is skipped for this cycle
+      ascentToPark = 0;
+      
+      //set downTime 
+      downTime = missionTime-20000;
+      downTimeDisplay = downTime/60000;
+      buildMissionSchedule();
+      
+      lastUpdate = missionClock();
+    }
+    
+    //if it is descending
+    else if(currentPosition < lastPosition - 5){
+      
+      //store the normalValue of downTime to be reset later
+      downTimeCopy = downTime;
+      
+      //set downTime
+      downTime = missionTime+deepProfileDescentTime - 15000;
+      downTimeDisplay = downTime/60000;
+      buildMissionSchedule();
+            
+      //set last update
+      lastUpdate = missionClock();
+      
+      //reset values of currentPosition and lastPosition
+      currentPosition = 0;
+    }
+  }
+  lastPosition=currentPosition;
+}
+
+
+/*************************************************************************/
+/*                           checkPistonAscent                           */
+/*                           *****************                           */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function determines whether the simulator should leave ascent    */
+/* based on whether the piston position is decreasing. If it is, reset   */
+/* all of the mission parameters. This functionality is in place to      */
+/* simulate the behaviour during ice avoidance. Reset all of the         */
+/* parameters by setting them equal to their copies. Also, set the last  */
+/* update to the timer value. Last, reset the values of last postion and */
+/* current position if the phase is changing.                            */
+/*                                                                       */
+/*************************************************************************/
+void checkPistonAscent(void){
+  updateTime();
+  currentPosition = readPiston();
+  trace(TRACE_PISTON, currentPosition);
+  if(lastPosition!=0){
+    
+    //if it is descending
+    if(currentPosition < lastPosition - 5){
+      
+      //reset all parameters, but shorten descent time
+      //will handle pressure during park by adding offset
+      //in getDynamicReading function
+      preludeDisplay = 0;
+      missionTime = 0;
+      missionTimeDisplay = 0;
+      parkDescentTime = ((parkPressure-icePressure)/parkPressure)*parkDescentTimeCopy;
+      parkDescentTimeDisplay = parkDescentTime/60000;
+      downTime = downTimeCopy;
+      downTimeDisplay = downTime/60000;
+      deepProfileDescentTime = deepProfileDescentTimeCopy;
+      deepProfileDescentTimeDisplay = deepProfileDescentTime/60000;
+      ascentTimeOut = ascentTimeOutCopy;
+      ascentTimeOutDisplay = ascentTimeOut/60000;
+      buildMissionSchedule();
+       
+      //set last update
+      lastUpdate = missionClock();
+      
+      //reset values of currentPosition and lastPosition
+      currentPosition = 0;
+    }
+  }
+  lastPosition = currentPosition;
+}
+
+
+/*************************************************************************/
+/*                           checkPistonPrelude                          */
+/*                           ******************                          */
+/*                                                                       */
+/* parameters: none                                                      */
+/*                                                                       */
+/* returns: none                                                         */
+/*                                                                       */
+/* This function determines whether the simulator should leave prelude   */
+/* based on whether the piston position is decreasing. If it is, set the */
+/* prelude equal to the current mission time. This will effectively end  */
+/* prelude phase in terms of calculating in the code. Also, set the last */
+/* update to the timer value. Last, reset the values of last postion and */
+/* current position if the phase is changing.                            */
+/*                                                                       */
+/*************************************************************************/
+
+void checkPistonPrelude(void){
+  updateTime();
+  currentPosition = readPiston();
+  if(lastPosition!=0){
+    
+    //if it is descending
+    if(currentPosition < lastPosition - 5){
+      
+      //set last update
+      lastUpdate = missionClock() - 85000;
+      
+      missionMode+=110;
+      
+      prelude = -1;
+      
+      //reset values of currentPosition and lastPosition
+      currentPosition = 0;
+    }
+  }
+  lastPosition = currentPosition;
+}
+
+/*************************************************************************/
+/*                               parseValue                              */
+/*                               **********                              */
+/*                                                                       */
+/* parameters: text, the value entered after a command (spaces removed)  */
+/*                                                                       */
+/* returns: a long integer value that represents the value entered       */
+/*                                                                       */
+/* This funciton converts the value the user entered after a command, it */
+/* will be used to allow the user to change mission parameters such as   */
+/* ice detection and mission depth and timing. "off" is returned as OFF. */
+/*                                                                       */
+/*************************************************************************/
+
+long parseValue(const char *text){
+  if(strcmp(text, "off")==0){
+    return OFF;
+  }
+  return atol(text);
+}
+
+
+
+/*************************************************************************/
+/*                              parseTenths                              */
+/*                              ***********                              */
+/*                                                                       */
+/* parameters: text, the text sent after a command ("2.0")               */
+/*                                                                       */
+/* returns: a long that represents the number in tenths, -1 if it isn't  */
+/*          a number of 0 or more                                        */
+/*                                                                       */
+/* This function reads a decimal number with at most one place that      */
+/* counts (oxnf=2.0, oxns=0.0) without float math, the places past the   */
+/* first are dropped.                                                    */
+/*                                                                       */
+/*************************************************************************/
+
+long parseTenths(const char *text){
+  long tenths = 0;
+  
+  if(!isdigit(*text)){
+    return -1;
+  }
+  while(isdigit(*text)){
+    tenths = tenths*10 + (*text++ - '0');
+  }
+  tenths *= 10;
+  if((*text == '.')&&isdigit(text[1])){
+    tenths += text[1] - '0';
+  }
+  return tenths;
+}
+
+
+
+/*************************************************************************/
+/*                             tenthsToChars                             */
+/*                             *************                             */
+/*                                                                       */
+/* parameters: buf, the char buffer the number is written into           */
+/*             tenths, a long in tenths that is 0 or more                */
+/*             places, the places after the decimal point (1)            */
+/*                                                                       */
+/* returns: a pointer to the null at the end of the number               */
+/*                                                                       */
+/* This function writes a number kept in tenths ("2.0"), the way         */
+/* pressureToChars writes one in hundredths.                             */
+/*                                                                       */
+/*************************************************************************/
+
+char *tenthsToChars(char *buf, long tenths, byte places){
+  buf = longToChars(buf, tenths/10);
+  buf = appendChars(buf, ".");
+  return digitsToChars(buf, tenths%10, places);
+}
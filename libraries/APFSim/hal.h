@@ -0,0 +1,278 @@
+/*************************************************************************/
+/*                                 hal.h                                 */
+/*                                 *****                                 */
+/*                                                                       */
+/* The hardware the simulator uses, behind a thin layer so the same      */
+/* sketch builds for the Mega and as a Linux program (host/, built with  */
+/* HOST defined). On the Mega these are inline wrappers of the arduino   */
+/* calls, on Linux they are in host/hal_host.cpp, where the CTD port is  */
+/* a pseudo-terminal, the hardware lines and piston come from a control  */
+/* file and the clock is virtual.                                        */
+/*                                                                       */
+/* ctd: Serial1, the SBE41 port to the float                             */
+/* readLine: the hardware lines (pins 2, 3 and 19)                       */
+/* readPiston: the piston position (A0, 0-1023)                          */
+/* writeLed: the LED that shows the simulator is on (pin 8)              */
+/* clock: millis(), micros() and delay()                                 */
+/* lineTimer: Timer1, paces the hardware line decoder                    */
+/* request: the interrupt on a rising edge of the request line (pin 2)   */
+/* replay: the recorded profile (REPLAYFILE on the SD card, chip select  */
+/*         SDCHIPSELECT), replayOpen gives its size in bytes (0 if there */
+/*         isn't one) and replayRead the bytes at an offset. On Linux it */
+/*         is the file given with -r, memory mapped, so replayRead only  */
+/*         points into it and the buffer isn't used                      */
+/* storage: the files the simulator records to on the SD card,           */
+/*          storageOpen opens a file and tells how many STORAGEBLOCK     */
+/*          byte blocks it has, storageWrite writes a whole block of it  */
+/*          in place or the block right after its end, and storageSync   */
+/*          puts what the card library still holds (and the size) on the */
+/*          card. On Linux they are in the directory given with -d,      */
+/*          without it there is no card                                  */
+/*                                                                       */
+/*************************************************************************/
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <Arduino.h>
+
+//the size of a block of the SD card and the most files the simulator records to
+#define STORAGEBLOCK 512
+#define STORAGEFILES 2
+
+#ifndef HOST
+
+/*************************************************************************/
+/*                              TimerOne.h                               */
+/*                              **********                               */
+/*                                                                       */
+/* Includes the source code for the timer that paces the hardware line   */
+/* decoder (checkLine and lineTick)                                      */
+/* in order to compile, you must download this library from the arduino  */
+/* playground online                                                     */
+/*                                                                       */
+/*************************************************************************/
+
+#include <TimerOne.h>
+
+/*************************************************************************/
+/*                                  SD.h                                 */
+/*                                  ****                                 */
+/*                                                                       */
+/* Includes the SD card library of the arduino software, for the         */
+/* recorded profile and the files the simulator records to               */
+/*                                                                       */
+/*************************************************************************/
+
+#include <SD.h>
+
+#define SDCHIPSELECT 53
+#define REPLAYFILE "REPLAY.BIN"
+
+//sets pins 2 (digital), 3 (digital), and A0 (analog) as inputs, pin 8 as an output,
+//and the analog reference (max) voltage at 2.56V
+inline void halSetup(void){
+  pinMode(8, OUTPUT);
+  pinMode(2, INPUT);
+  pinMode(3, INPUT);
+  pinMode(A0, INPUT);
+  analogReference(INTERNAL2V56);
+}
+
+inline void ctdBegin(long baud){
+  Serial1.begin(baud);
+}
+
+inline int ctdAvailable(void){
+  return Serial1.available();
+}
+
+inline int ctdRead(void){
+  return Serial1.read();
+}
+
+inline int ctdAvailableForWrite(void){
+  return Serial1.availableForWrite();
+}
+
+inline void ctdWrite(byte data){
+  Serial1.write(data);
+}
+
+inline void ctdFlush(void){
+  Serial1.flush();
+}
+
+inline int readLine(int pin){
+  return digitalRead(pin);
+}
+
+inline int readPiston(void){
+  return analogRead(A0);
+}
+
+inline void writeLed(int value){
+  digitalWrite(8, value);
+}
+
+inline unsigned long clockMillis(void){
+  return millis();
+}
+
+inline unsigned long clockMicros(void){
+  return micros();
+}
+
+inline void clockDelay(unsigned long ms){
+  delay(ms);
+}
+
+inline void lineTimerInit(long period, void (*isr)(void)){
+  Timer1.initialize(period);
+  Timer1.attachInterrupt(isr);
+  Timer1.stop();
+}
+
+inline void lineTimerStart(void){
+  Timer1.start();
+}
+
+inline void lineTimerStop(void){
+  Timer1.stop();
+}
+
+inline void requestAttach(void (*isr)(void)){
+  attachInterrupt(0, isr, RISING);
+}
+
+inline void requestDetach(void){
+  detachInterrupt(0);
+}
+
+//the card is started once, for the recorded profile and the storage files
+inline boolean sdBegin(void){
+  static boolean started = false;
+  if(!started){
+    started = SD.begin(SDCHIPSELECT);
+  }
+  return started;
+}
+
+//the recorded profile stays open from replayOpen on
+inline File &replayFile(void){
+  static File file;
+  return file;
+}
+
+inline long replayOpen(void){
+  if(replayFile()){
+    replayFile().close();
+  }
+  if(!sdBegin()){
+    return 0;
+  }
+  replayFile() = SD.open(REPLAYFILE, FILE_READ);
+  if(!replayFile()){
+    return 0;
+  }
+  return replayFile().size();
+}
+
+inline const byte *replayRead(unsigned long offset, byte *buffer, int len){
+  if(!replayFile()||!replayFile().seek(offset)||(replayFile().read(buffer, len) != len)){
+    return NULL;
+  }
+  return buffer;
+}
+
+//the storage files stay open from storageOpen on
+inline File &storageFile(byte file){
+  static File files[STORAGEFILES];
+  return files[file];
+}
+
+//opened without O_APPEND so a block can be written in place, the blocks a file is short of
+//are added by the store job a few at a time, nothing here waits for a whole file to be written
+inline long storageOpen(byte file, const char *name){
+  File &f = storageFile(file);
+  
+  if(f){
+    f.close();
+  }
+  if(!sdBegin()){
+    return -1;
+  }
+  f = SD.open(name, O_READ | O_WRITE | O_CREAT);
+  if(!f){
+    return -1;
+  }
+  return f.size()/STORAGEBLOCK;
+}
+
+//left in the card library's cache until storageSync or the next block needs the cache
+inline boolean storageWrite(byte file, unsigned long block, const byte *data){
+  File &f = storageFile(file);
+  if(!f||!f.seek(block*STORAGEBLOCK)||(f.write(data, STORAGEBLOCK) != STORAGEBLOCK)){
+    return false;
+  }
+  return true;
+}
+
+inline void storageSync(byte file){
+  File &f = storageFile(file);
+  if(f){
+    f.flush();
+  }
+}
+
+#else
+
+void halSetup(void);
+
+void ctdBegin(long);
+
+int ctdAvailable(void);
+
+int ctdRead(void);
+
+int ctdAvailableForWrite(void);
+
+void ctdWrite(byte);
+
+void ctdFlush(void);
+
+int readLine(int);
+
+int readPiston(void);
+
+void writeLed(int);
+
+unsigned long clockMillis(void);
+
+unsigned long clockMicros(void);
+
+void clockDelay(unsigned long);
+
+void lineTimerInit(long, void (*)(void));
+
+void lineTimerStart(void);
+
+void lineTimerStop(void);
+
+void requestAttach(void (*)(void));
+
+void requestDetach(void);
+
+long replayOpen(void);
+
+const byte *replayRead(unsigned long, byte *, int);
+
+long storageOpen(byte, const char *);
+
+boolean storageWrite(byte, unsigned long, const byte *);
+
+void storageSync(byte);
+
+#endif
+
+#endif
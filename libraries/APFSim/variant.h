@@ -0,0 +1,135 @@
+/*************************************************************************/
+/*                               variant.h                               */
+/*                               *********                               */
+/*                                                                       */
+/* The controller and seabird each sketch simulates. A sketch defines    */
+/* VARIANT as one of the VARIANT_* below before including APFSim.h, the  */
+/* default is APF_9_APF_11_sim. Everything that differs between them is  */
+/* a trait here, a feature a variant doesn't have is left out of the     */
+/* command table and its code is never called, so it isn't in the build */
+/* (flash and SRAM).                                                     */
+/*                                                                       */
+/* SIMNAME: the title of the help (?) command                            */
+/* CTDID: the identity sent when the APFx asks for the serial number     */
+/* CTDMODEL: the model in the first line of ds and dc                    */
+/* CTDFIRMWARE: the firmware lines of ds                                 */
+/* HAS_CP: a continuous profiling seabird (SBE41cp/61): startprofile,    */
+/*         binaverage, the uploads, the bin settings and qsr. Without    */
+/*         it the seabird is an SBE41 STD (ARGOS): pumpfastpt,           */
+/*         outputdensity, addtimingdelays and qs                         */
+/* HAS_OXYGEN: an SBE43F on the seabird, oxnf= sets the pump it waits    */
+/*             for before a sample and dc shows its settings             */
+/* HAS_MISSION: the mission commands (Mk, Mtd..., e, k, i*l...) and the  */
+/*              mission driven readings                                  */
+/* HAS_BUILD: the build command of the APF-11                            */
+/* PROFILESTOPPED: the reply to stopprofile                              */
+/* PARKPRESSUREDEFAULT, DEEPPROFILEPRESSUREDEFAULT: the mission (dbar)   */
+/* PISTONGAIN: the gain of the piston input hardware                     */
+/*                                                                       */
+/*************************************************************************/
+
+#ifndef VARIANT_H
+#define VARIANT_H
+
+#define VARIANT_APF9_APF11 0
+#define VARIANT_APF9 1
+#define VARIANT_APF11 2
+#define VARIANT_APF9_ICE 3
+#define VARIANT_APF9_ARGOS 4
+#define VARIANT_APF11_DEEP 5
+
+#ifndef VARIANT
+#define VARIANT VARIANT_APF9_APF11
+#endif
+
+//APF_9_APF_11_sim: APF-9 or APF-11 with an SBE41cp
+#if VARIANT == VARIANT_APF9_APF11
+#define SIMNAME "APF-9 & APF-11 Iridium SBE41cp Simulator"
+#define HAS_MISSION 1
+#define HAS_BUILD 0
+#define PISTONGAIN 1.0
+
+//finished_code: APF-9 with an SBE41cp, readings from the piston only
+#elif VARIANT == VARIANT_APF9
+#define SIMNAME "APF-9 Iridium SBE41cp Simulator"
+#define HAS_MISSION 0
+#define HAS_BUILD 0
+#define PISTONGAIN 1.08
+
+//finished_code_11: APF-11 with an SBE41cp, readings from the piston only
+#elif VARIANT == VARIANT_APF11
+#define SIMNAME "APF-11 Iridium SBE41cp Simulator"
+#define HAS_MISSION 0
+#define HAS_BUILD 1
+#define PROFILESTOPPED "stopprofile"
+#define PISTONGAIN 1.08
+
+//finished_code_9_ice: APF-9 with an SBE41cp, ice avoidance missions
+#elif VARIANT == VARIANT_APF9_ICE
+#define SIMNAME "APF-9 Iridium SBE41cp Simulator"
+#define HAS_MISSION 1
+#define HAS_BUILD 0
+#define PISTONGAIN 1.0
+
+//APF_9_ARGOS_sim: APF-9 with an SBE41 STD (no continuous profiling)
+#elif VARIANT == VARIANT_APF9_ARGOS
+#define SIMNAME "APF-9 ARGO SBE41 Simulator"
+#define CTDID "SBE 41-ALACE"
+#define CTDMODEL "SBE 41-STD V 2.0"
+#define CTDFIRMWARE "\r\nfirmware compilation date: 17 December 2007 16:30"
+#define HAS_CP 0
+#define HAS_OXYGEN 1
+#define HAS_MISSION 1
+#define HAS_BUILD 0
+#define PISTONGAIN 1.08
+
+//APF_11_deep_sim: APF-11 deep with an SBE61
+#elif VARIANT == VARIANT_APF11_DEEP
+#define SIMNAME "APF-11 Deep Iridium SBE61cp Simulator"
+#define CTDID "SBE 61 V 4.5.2"
+#define CTDMODEL "SBE 61 V 4.5.2"
+#define CTDFIRMWARE "\r\nvariant: standard\r\nfirmware date: Feb  7 2014 12:51:20"
+#define HAS_MISSION 1
+#define HAS_BUILD 0
+#define PARKPRESSUREDEFAULT 2000
+#define DEEPPROFILEPRESSUREDEFAULT 4000
+#define PISTONGAIN 1.08
+
+#else
+#error "VARIANT is not one of the VARIANT_* in variant.h"
+#endif
+
+//what the variants have unless they say otherwise, mostly the SBE41cp
+#ifndef CTDID
+#define CTDID "SBE 41CP UW. V 2.0"
+#endif
+
+#ifndef CTDMODEL
+#define CTDMODEL "SBE 41CP UW V 2.0"
+#endif
+
+#ifndef CTDFIRMWARE
+#define CTDFIRMWARE "\r\nfirmware compilation date: 18 December 2007 09:20"
+#endif
+
+#ifndef HAS_CP
+#define HAS_CP 1
+#endif
+
+#ifndef HAS_OXYGEN
+#define HAS_OXYGEN 0
+#endif
+
+#ifndef PROFILESTOPPED
+#define PROFILESTOPPED "profile stopped"
+#endif
+
+#ifndef PARKPRESSUREDEFAULT
+#define PARKPRESSUREDEFAULT 1000
+#endif
+
+#ifndef DEEPPROFILEPRESSUREDEFAULT
+#define DEEPPROFILEPRESSUREDEFAULT 2000
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+###########################################################################
+#                                                                         #
+#                                replay.py                                #
+#                                #########                                #
+#                                                                         #
+# Makes the recorded profile the simulator replays (replay on) from real  #
+# float data. Every line of the input with 3 or 4 numbers on it is a      #
+# sample, pressure (dbar), temperature (deg C), salinity (PSU) and        #
+# optionally oxygen (Hz), as the SBE41 sends them ("p, t, s", the lines   #
+# of a dd upload or a log of the CTD port); everything else is skipped.   #
+# The samples are sorted by pressure and the samples at the same          #
+# pressure are averaged.                                                  #
+#                                                                         #
+# The output is a 16 byte header, "APFR", the version (2 bytes), the      #
+# size of a record (2 bytes), the number of records (4 bytes) and the     #
+# flags (4 bytes, 1 if there is oxygen), then one 16 byte record per      #
+# sample: pressure (hundredths of a dbar), temperature and salinity       #
+# (ten thousandths) and oxygen (Hz, 0 if there is none), all little       #
+# endian 32 bit integers, so neither the Mega nor the Linux build has to  #
+# parse anything. Copy it to the SD card of the Mega as REPLAY.BIN, or    #
+# give it to the Linux build with -r.                                     #
+#                                                                         #
+# python replay.py profile.txt [more.txt...] -o REPLAY.BIN                #
+#                                                                         #
+###########################################################################
+
+from __future__ import print_function
+
+import argparse
+import re
+import struct
+import sys
+
+#the header and records of the recorded profile, as startReplay in APFSim.h reads them
+MAGIC = b'APFR'
+VERSION = 1
+HEADER = struct.Struct('<4sHHII')
+RECORD = struct.Struct('<iiii')
+OXYGEN = 1
+
+#the numbers of a sample, separated by commas and/or spaces
+NUMBER = re.compile(r'[-+]?[0-9]*\.?[0-9]+')
+SAMPLE = re.compile(r'^\s*[-+]?[0-9]*\.?[0-9]+(\s*,\s*|\s+)[-+]?[0-9]*\.?[0-9]+(\s*,\s*|\s+)'
+                    r'[-+]?[0-9]*\.?[0-9]+((\s*,\s*|\s+)[-+]?[0-9]*\.?[0-9]+)?\s*$')
+
+
+
+###########################################################################
+#                                                                         #
+#                               readSamples                               #
+#                               ###########                               #
+#                                                                         #
+# parameters: name, the file to read                                      #
+#                                                                         #
+# returns: the samples in it as (pressure, temperature, salinity,         #
+#          oxygen) in the units of the records, oxygen is None if the     #
+#          line had none                                                  #
+#                                                                         #
+###########################################################################
+
+def readSamples(name):
+    samples = []
+    with open(name) as f:
+        for line in f:
+            line = line.replace('S>', '').replace('\x00', '')
+            if not SAMPLE.match(line):
+                continue
+            values = [float(v) for v in NUMBER.findall(line)]
+            oxygen = int(round(values[3])) if len(values) == 4 else None
+            samples.append((int(round(values[0]*100)), int(round(values[1]*10000)),
+                            int(round(values[2]*10000)), oxygen))
+    return samples
+
+
+
+###########################################################################
+#                                                                         #
+#                              mergeSamples                               #
+#                              ############                               #
+#                                                                         #
+# parameters: samples, the samples of readSamples                         #
+#                                                                         #
+# returns: the records, sorted by pressure, the samples at the same       #
+#          pressure averaged so the simulator never interpolates over no  #
+#          pressure                                                       #
+#                                                                         #
+###########################################################################
+
+def mergeSamples(samples):
+    merged = []
+    samples = sorted(samples, key=lambda s: s[0])
+    i = 0
+    while i < len(samples):
+        j = i
+        while j < len(samples) and samples[j][0] == samples[i][0]:
+            j += 1
+        same = samples[i:j]
+        oxygen = [s[3] for s in same if s[3] is not None]
+        merged.append((same[0][0],
+                       int(round(sum(s[1] for s in same)/float(len(same)))),
+                       int(round(sum(s[2] for s in same)/float(len(same)))),
+                       int(round(sum(oxygen)/float(len(oxygen)))) if oxygen else 0))
+        i = j
+    return merged
+
+
+
+def main():
+    parser = argparse.ArgumentParser(description='make a recorded profile for the simulator to replay')
+    parser.add_argument('inputs', nargs='+')
+    parser.add_argument('-o', '--out', default='REPLAY.BIN')
+    args = parser.parse_args()
+
+    samples = []
+    for name in args.inputs:
+        samples += readSamples(name)
+    if not samples:
+        print('no samples (p, t, s[, o]) in %s' % ', '.join(args.inputs), file=sys.stderr)
+        return 1
+    flags = OXYGEN if any(s[3] is not None for s in samples) else 0
+    records = mergeSamples(samples)
+
+    with open(args.out, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, VERSION, RECORD.size, len(records), flags))
+        for record in records:
+            f.write(RECORD.pack(*record))
+    print('%s: %d records from %.2f to %.2f dbar%s' % (args.out, len(records), records[0][0]/100.0,
+          records[-1][0]/100.0, ' with oxygen' if flags & OXYGEN else ''))
+    return 0
+
+
+
+if __name__ == '__main__':
+    sys.exit(main())